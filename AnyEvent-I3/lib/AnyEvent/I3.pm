@@ -102,12 +102,15 @@ use constant TYPE_GET_CONFIG => 9;
 use constant TYPE_SEND_TICK => 10;
 use constant TYPE_SYNC => 11;
 use constant TYPE_GET_BINDING_STATE => 12;
+use constant TYPE_GET_TREE_SNAPSHOT => 13;
+use constant TYPE_GET_POOL_STATS => 14;
 
 our %EXPORT_TAGS = ( 'all' => [
     qw(i3 TYPE_RUN_COMMAND TYPE_COMMAND TYPE_GET_WORKSPACES TYPE_SUBSCRIBE TYPE_GET_OUTPUTS
        TYPE_GET_TREE TYPE_GET_MARKS TYPE_GET_BAR_CONFIG TYPE_GET_VERSION
        TYPE_GET_BINDING_MODES TYPE_GET_CONFIG TYPE_SEND_TICK TYPE_SYNC
-       TYPE_GET_BINDING_STATE)
+       TYPE_GET_BINDING_STATE TYPE_GET_TREE_SNAPSHOT
+       TYPE_GET_POOL_STATS)
 ] );
 
 our @EXPORT_OK = ( @{ $EXPORT_TAGS{all} } );
@@ -125,6 +128,7 @@ my %events = (
     binding => ($event_mask | 5),
     shutdown => ($event_mask | 6),
     tick => ($event_mask | 7),
+    tree => ($event_mask | 8),
     _error => 0xFFFFFFFF,
 );
 
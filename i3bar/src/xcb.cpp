@@ -157,10 +157,11 @@ static int get_tray_width(struct tc_head *trayclients) {
 }
 
 /*
- * Draws a separator for the given block if necessary.
+ * Draws a separator for the given block if necessary. Classic one pixel
+ * separators are added to the batch.
  *
  */
-static void draw_separator(i3_output *output, uint32_t x, struct status_block *block, bool use_focus_colors) {
+static void draw_separator(i3_output *output, rect_batch_t *batch, uint32_t x, struct status_block *block, bool use_focus_colors) {
     color_t sep_fg = (use_focus_colors ? colors.focus_sep_fg : colors.sep_fg);
     color_t bar_bg = (use_focus_colors ? colors.focus_bar_bg : colors.bar_bg);
 
@@ -171,11 +172,11 @@ static void draw_separator(i3_output *output, uint32_t x, struct status_block *b
     uint32_t center_x = x - sep_offset;
     if (config.separator_symbol == NULL) {
         /* Draw a classic one pixel, vertical separator. */
-        draw_util_rectangle(&output->statusline_buffer, sep_fg,
-                            center_x,
-                            logical_px(sep_voff_px),
-                            logical_px(1),
-                            bar_height - 2 * logical_px(sep_voff_px));
+        draw_util_batch_rectangle(batch, sep_fg,
+                                  center_x,
+                                  logical_px(sep_voff_px),
+                                  logical_px(1),
+                                  bar_height - 2 * logical_px(sep_voff_px));
     } else {
         /* Draw a custom separator. */
         uint32_t separator_x = MAX(x - block->sep_block_width, center_x - separator_symbol_width / 2);
@@ -233,11 +234,63 @@ static uint32_t predict_statusline_length(bool use_short_text) {
     return width;
 }
 
+/*
+ * Returns the render description of the text the block shows.
+ *
+ */
+static struct status_block_render_desc *get_block_render(struct status_block *block, bool use_short_text, i3String **text) {
+    *text = block->full_text;
+    if (use_short_text && block->short_text != NULL) {
+        *text = block->short_text;
+        return &block->short_render;
+    }
+    return &block->full_render;
+}
+
+/*
+ * Determines the colors of the block. Returns true if the block has a border
+ * or background box which needs to be drawn.
+ *
+ */
+static bool get_block_colors(struct status_block *block, bool use_focus_colors,
+                             color_t *fg_color, color_t *bg_color, color_t *border_color) {
+    color_t bar_color = (use_focus_colors ? colors.focus_bar_bg : colors.bar_bg);
+
+    if (block->urgent) {
+        *fg_color = colors.urgent_ws_fg;
+    } else if (block->color) {
+        *fg_color = draw_util_hex_to_color(block->color);
+    } else if (use_focus_colors) {
+        *fg_color = colors.focus_bar_fg;
+    } else {
+        *fg_color = colors.bar_fg;
+    }
+
+    *bg_color = bar_color;
+    *border_color = bar_color;
+    if (!block->border && !block->background && !block->urgent)
+        return false;
+
+    if (block->urgent) {
+        *border_color = colors.urgent_ws_border;
+        *bg_color = colors.urgent_ws_bg;
+    } else {
+        if (block->border)
+            *border_color = draw_util_hex_to_color(block->border);
+        if (block->background)
+            *bg_color = draw_util_hex_to_color(block->background);
+    }
+    return true;
+}
+
 /*
  * Redraws the statusline to the output's statusline_buffer
  */
 static void draw_statusline(i3_output *output, uint32_t clip_left, bool use_focus_colors, bool use_short_text) {
     struct status_block *block;
+    i3String *text;
+    struct status_block_render_desc *render;
+    color_t fg_color, bg_color, border_color;
 
     color_t bar_color = (use_focus_colors ? colors.focus_bar_bg : colors.bar_bg);
     draw_util_clear_surface(&output->statusline_buffer, bar_color);
@@ -250,71 +303,60 @@ static void draw_statusline(i3_output *output, uint32_t clip_left, bool use_focu
      * actually rendering content to the surface. */
     uint32_t x = 0 - clip_left;
 
-    /* Draw the text of each block */
+    /* Draw the borders, backgrounds and separators of all blocks first, so
+     * that they can be filled with one path per color. */
+    rect_batch_t batch;
+    draw_util_batch_begin(&batch, &output->statusline_buffer);
     TAILQ_FOREACH (block, &statusline_head, blocks) {
-        i3String *text = block->full_text;
-        struct status_block_render_desc *render = &block->full_render;
-        if (use_short_text && block->short_text != NULL) {
-            text = block->short_text;
-            render = &block->short_render;
-        }
-
+        render = get_block_render(block, use_short_text, &text);
         if (i3string_get_num_bytes(text) == 0)
             continue;
 
-        color_t fg_color;
-        if (block->urgent) {
-            fg_color = colors.urgent_ws_fg;
-        } else if (block->color) {
-            fg_color = draw_util_hex_to_color(block->color);
-        } else if (use_focus_colors) {
-            fg_color = colors.focus_bar_fg;
-        } else {
-            fg_color = colors.bar_fg;
-        }
-
-        color_t bg_color = bar_color;
-
         int full_render_width = render->width + render->x_offset + render->x_append;
         int has_border = block->border ? 1 : 0;
-        if (block->border || block->background || block->urgent) {
-            /* Let's determine the colors first. */
-            color_t border_color = bar_color;
-            if (block->urgent) {
-                border_color = colors.urgent_ws_border;
-                bg_color = colors.urgent_ws_bg;
-            } else {
-                if (block->border)
-                    border_color = draw_util_hex_to_color(block->border);
-                if (block->background)
-                    bg_color = draw_util_hex_to_color(block->background);
-            }
-
+        if (get_block_colors(block, use_focus_colors, &fg_color, &bg_color, &border_color)) {
             /* Draw the border. */
-            draw_util_rectangle(&output->statusline_buffer, border_color,
-                                x, logical_px(1),
-                                full_render_width,
-                                bar_height - logical_px(2));
+            draw_util_batch_rectangle(&batch, border_color,
+                                      x, logical_px(1),
+                                      full_render_width,
+                                      bar_height - logical_px(2));
 
             /* Draw the background. */
-            draw_util_rectangle(&output->statusline_buffer, bg_color,
-                                x + has_border * logical_px(block->border_left),
-                                logical_px(1) + has_border * logical_px(block->border_top),
-                                full_render_width - has_border * logical_px(block->border_right + block->border_left),
-                                bar_height - has_border * logical_px(block->border_bottom + block->border_top) - logical_px(2));
+            draw_util_batch_rectangle(&batch, bg_color,
+                                      x + has_border * logical_px(block->border_left),
+                                      logical_px(1) + has_border * logical_px(block->border_top),
+                                      full_render_width - has_border * logical_px(block->border_right + block->border_left),
+                                      bar_height - has_border * logical_px(block->border_bottom + block->border_top) - logical_px(2));
         }
+        x += full_render_width;
+
+        /* If this is not the last block, draw a separator. */
+        if (TAILQ_NEXT(block, blocks) != NULL) {
+            x += block->sep_block_width;
+            draw_separator(output, &batch, x, block, use_focus_colors);
+        }
+    }
+    draw_util_batch_flush(&batch);
 
+    /* Draw the text of each block */
+    x = 0 - clip_left;
+    TAILQ_FOREACH (block, &statusline_head, blocks) {
+        render = get_block_render(block, use_short_text, &text);
+        if (i3string_get_num_bytes(text) == 0)
+            continue;
+
+        get_block_colors(block, use_focus_colors, &fg_color, &bg_color, &border_color);
+
+        int full_render_width = render->width + render->x_offset + render->x_append;
+        int has_border = block->border ? 1 : 0;
         draw_util_text(text, &output->statusline_buffer, fg_color, bg_color,
                        x + render->x_offset + has_border * logical_px(block->border_left),
                        bar_height / 2 - font.height / 2,
                        render->width - has_border * logical_px(block->border_left + block->border_right));
         x += full_render_width;
 
-        /* If this is not the last block, draw a separator. */
-        if (TAILQ_NEXT(block, blocks) != NULL) {
+        if (TAILQ_NEXT(block, blocks) != NULL)
             x += block->sep_block_width;
-            draw_separator(output, x, block, use_focus_colors);
-        }
     }
 }
 
@@ -1529,6 +1571,10 @@ void init_tray_colors(void) {
 void clean_xcb(void) {
     free_outputs();
 
+    unsigned long hits, misses;
+    text_width_cache_stats(&hits, &misses);
+    DLOG("text width cache: %lu hits, %lu misses\n", hits, misses);
+
     free_font();
 
     xcb_free_cursor(xcb_connection, cursor);
@@ -34,6 +34,7 @@
 
 #include "libi3.hpp"
 #include "data.hpp"
+#include "hashtable.hpp"
 #include "util.hpp"
 #include "ipc.hpp"
 #include "tree.hpp"
@@ -75,4 +76,5 @@
 #include "display_version.hpp"
 #include "restore_layout.hpp"
 #include "sync.hpp"
+#include "tree_delta.hpp"
 #include "main.hpp"
@@ -13,6 +13,22 @@
 
 #include <config.hpp>
 
+/**
+ * Marks the given container and all of its ancestors as changed, so that the
+ * next tree_render() will not skip the workspace it is on.
+ *
+ */
+void con_mark_dirty(Con *con);
+
+/**
+ * Returns true if the given container is a workspace which is not the visible
+ * workspace of its output and in which nothing changed since the last
+ * tree_render(). Such a workspace has already been unmapped and pushed to X11
+ * completely, so the render passes can skip its subtree.
+ *
+ */
+bool con_is_clean_hidden_workspace(Con *con);
+
 /**
  * Create a new container (and attach it to the given parent, if not NULL).
  * This function only initializes the data structures.
@@ -181,18 +197,29 @@ bool con_has_parent(Con *con, Con *parent);
 Con *con_by_window_id(xcb_window_t window);
 
 /**
- * Returns the container with the given container ID or NULL if no such
- * container exists.
+ * Adds the client window of the given container to the index used by
+ * con_by_window_id(). Has to be called whenever con->window is assigned.
  *
  */
-Con *con_by_con_id(long target);
+void con_index_window(Con *con);
 
 /**
- * Returns true if the given container (still) exists.
- * This can be used, e.g., to make sure a container hasn't been closed in the meantime.
+ * Removes the client window of the given container from the index used by
+ * con_by_window_id(). Has to be called before con->window is freed or handed
+ * over to another container.
  *
  */
-bool con_exists(Con *con);
+void con_unindex_window(Con *con);
+
+/**
+ * Returns the container with the given container ID (see Con.id) or NULL if no
+ * such container exists (anymore).
+ *
+ * Since IDs are never reused, this can also be used to make sure a container
+ * hasn't been closed in the meantime.
+ *
+ */
+Con *con_by_con_id(long target);
 
 /**
  * Returns the container with the given frame ID or NULL if no such container
@@ -201,6 +228,20 @@ bool con_exists(Con *con);
  */
 Con *con_by_frame_id(xcb_window_t frame);
 
+/**
+ * Adds the frame of the given container to the index used by
+ * con_by_frame_id(). Called from x_con_init() once the frame exists.
+ *
+ */
+void con_index_frame(Con *con);
+
+/**
+ * Removes the frame of the given container from the index used by
+ * con_by_frame_id().
+ *
+ */
+void con_unindex_frame(Con *con);
+
 /**
  * Returns the container with the given mark or NULL if no such container
  * exists.
@@ -237,6 +278,22 @@ void con_mark(Con *con, const char *mark, mark_mode_t mode);
  */
 void con_unmark(Con *con, const char *name);
 
+/**
+ * Returns the visible marks of the container (those not starting with an
+ * underscore) formatted for its window decoration as "[mark1][mark2]", or NULL
+ * if there are none. The predicted width of the string is stored in width.
+ *
+ * The result is cached on the container until its marks or the font change.
+ *
+ */
+i3String *con_get_formatted_marks(Con *con, int *width);
+
+/**
+ * Drops the cached result of con_get_formatted_marks().
+ *
+ */
+void con_invalidate_formatted_marks(Con *con);
+
 /**
  * Returns the first container below 'con' which wants to swallow this window
  * TODO: priority
@@ -516,6 +573,14 @@ void con_set_urgency(Con *con, bool urgent);
  */
 char *con_get_tree_representation(Con *con);
 
+/**
+ * Drops the cached tree representation of the container and of all its
+ * ancestors. Has to be called whenever the layout, the children or the window
+ * class of the container change.
+ *
+ */
+void con_invalidate_tree_representation(Con *con);
+
 /**
  * force parent split containers to be redrawn
  *
@@ -18,6 +18,7 @@
 #include <cairo/cairo.h>
 
 #include "queue.hpp"
+#include "memory.hpp"
 
 /*
  * To get the big concept: There are helper structures like struct
@@ -49,6 +50,7 @@ namespace i3 {
 struct Window;
 }
 struct mark_t;
+struct con_state;
 
 /******************************************************************************
  * Helper types
@@ -479,6 +481,9 @@ struct Window {
 
     /** Window icon, as Cairo surface */
     cairo_surface_t *icon;
+    /** The icon scaled for the decoration, see window_get_scaled_icon(). */
+    cairo_surface_t *icon_scaled;
+    int icon_scaled_size;
 
     /** The window has a nonrectangular shape. */
     bool shaped;
@@ -535,7 +540,8 @@ struct Match {
            WM_FLOATING_AUTO,
            WM_FLOATING_USER,
            WM_FLOATING } window_mode;
-    Con *con_id;
+    /* The ID (see Con.id) of the container to match or 0. */
+    uint64_t con_id;
 
     /* Where the window looking for a match should be inserted:
      *
@@ -612,58 +618,15 @@ struct mark_t {
 };
 
 /**
- * A 'Con' represents everything from the X11 root window down to a single X11 window.
+ * The rarely used parts of a Con. They are kept in a separate allocation so
+ * that walking the tree (rendering, finding the workspace of a container, …)
+ * does not need to pull them into the cache.
  *
  */
-struct Con {
-    bool mapped;
-
-    /* Should this container be marked urgent? This gets set when the window
-     * inside this container (if any) sets the urgency hint, for example. */
-    bool urgent;
-
-    /** This counter contains the number of UnmapNotify events for this
-     * container (or, more precisely, for its ->frame) which should be ignored.
-     * UnmapNotify events need to be ignored when they are caused by i3 itself,
-     * for example when reparenting or when unmapping the window on a workspace
-     * change. */
-    uint8_t ignore_unmap;
-
-    /* The surface used for the frame window. */
-    surface_t frame;
-    surface_t frame_buffer;
-    bool pixmap_recreated;
-
-    enum type {
-        CT_ROOT = 0,
-        CT_OUTPUT = 1,
-        CT_CON = 2,
-        CT_FLOATING_CON = 3,
-        CT_WORKSPACE = 4,
-        CT_DOCKAREA = 5
-    };
-    type type;
-
-    /** the workspace number, if this Con is of type CT_WORKSPACE and the
-     * workspace is not a named workspace (for named workspaces, num == -1) */
-    int num;
-
-    struct Con *parent;
-
-    /* The position and size for this con. These coordinates are absolute. Note
-     * that the rect of a container does not include the decoration. */
-    struct Rect rect;
-    /* The position and size of the actual client window. These coordinates are
-     * relative to the container's rect. */
-    struct Rect window_rect;
-    /* The position and size of the container's decoration. These coordinates
-     * are relative to the container's parent's rect. */
-    struct Rect deco_rect;
+struct con_cold {
     /** the geometry this window requested when getting mapped */
     struct Rect geometry;
 
-    char *name;
-
     /** The format with which the window's name should be displayed. */
     char *title_format;
 
@@ -681,35 +644,58 @@ struct Con {
     TAILQ_HEAD(marks_head, mark_t) marks_head;
     /* cached to decide whether a redraw is needed */
     bool mark_changed;
-
-    double percent;
-
-    /* the x11 border pixel attribute */
-    int border_width;
-    int current_border_width;
-
-    i3::Window *window;
+    /* cache for con_get_formatted_marks() */
+    i3String *formatted_marks;
+    int formatted_marks_width;
+    bool formatted_marks_valid;
 
     /* timer used for disabling urgency */
     struct ev_timer *urgency_timer;
 
-    /** Cache for the decoration rendering */
-    struct deco_render_params *deco_render_params;
+    TAILQ_HEAD(swallow_head, Match) swallow_head;
 
-    /* Only workspace-containers can have floating clients */
-    TAILQ_HEAD(floating_head, Con) floating_head;
+    /* The ID of this container before restarting. Necessary to correctly
+     * interpret back-references in the JSON (such as the focus stack). */
+    long long old_id;
 
-    TAILQ_HEAD(nodes_head, Con) nodes_head;
-    TAILQ_HEAD(focus_head, Con) focus_head;
+    /* The colormap for this con if a custom one is used. */
+    xcb_colormap_t colormap;
 
-    TAILQ_HEAD(swallow_head, Match) swallow_head;
+    /* cache for con_get_tree_representation() */
+    char *tree_representation;
 
-    fullscreen_mode_t fullscreen_mode;
+    /* Changes recorded for the next "tree" event (TREE_DELTA_* bits and
+     * TREE_DELTA_ADDED/TREE_DELTA_CHILDREN) and whether the container has been
+     * reported to clients before, see tree_delta.c. */
+    uint32_t tree_delta;
+    bool tree_delta_announced;
 
-    /* Whether this window should stick to the glass. This corresponds to
-     * the _NET_WM_STATE_STICKY atom and will only be respected if the
-     * window is floating. */
-    bool sticky;
+    /* The rendered title bar of a tabbed/stacked child and the key it was
+     * rendered from, see x_draw_title_strip(). */
+    surface_t title_strip;
+    char *title_strip_key;
+    size_t title_strip_key_len;
+};
+
+/**
+ * A 'Con' represents everything from the X11 root window down to a single X11 window.
+ *
+ * The fields used when walking and rendering the tree come first, the rarely
+ * used ones are in the separately allocated con_cold.
+ *
+ */
+struct Con {
+    struct Con *parent;
+
+    enum type {
+        CT_ROOT = 0,
+        CT_OUTPUT = 1,
+        CT_CON = 2,
+        CT_FLOATING_CON = 3,
+        CT_WORKSPACE = 4,
+        CT_DOCKAREA = 5
+    };
+    type type;
 
     /* layout is the layout of this container: one of split[v|h], stacked or
      * tabbed. Special containers in the tree (above workspaces) have special
@@ -727,6 +713,26 @@ struct Con {
      * layout whenever a new container is attached to the workspace. */
     layout_t layout, last_split_layout, workspace_layout;
     border_style_t border_style;
+
+    bool mapped;
+
+    /** Set when this container or one of its descendants changed since the
+     * last tree_render(). Hidden workspaces which are not dirty have already
+     * been pushed to X11 and are skipped when rendering. See
+     * con_mark_dirty(). */
+    bool dirty;
+
+    /* Should this container be marked urgent? This gets set when the window
+     * inside this container (if any) sets the urgency hint, for example. */
+    bool urgent;
+
+    /* Whether this window should stick to the glass. This corresponds to
+     * the _NET_WM_STATE_STICKY atom and will only be respected if the
+     * window is floating. */
+    bool sticky;
+
+    fullscreen_mode_t fullscreen_mode;
+
     /** floating? (= not in tiling layout) This cannot be simply a bool
      * because we want to keep track of whether the status was set by the
      * application (by setting _NET_WM_WINDOW_TYPE appropriately) or by the
@@ -740,11 +746,72 @@ struct Con {
         FLOATING_USER_ON = 3
     } floating;
 
+    /** the workspace number, if this Con is of type CT_WORKSPACE and the
+     * workspace is not a named workspace (for named workspaces, num == -1) */
+    int num;
+
+    double percent;
+
+    /* The position and size for this con. These coordinates are absolute. Note
+     * that the rect of a container does not include the decoration. */
+    struct Rect rect;
+    /* The position and size of the actual client window. These coordinates are
+     * relative to the container's rect. */
+    struct Rect window_rect;
+    /* The position and size of the container's decoration. These coordinates
+     * are relative to the container's parent's rect. */
+    struct Rect deco_rect;
+
+    /* the x11 border pixel attribute */
+    int border_width;
+    int current_border_width;
+
+    i3::Window *window;
+
+    /* Only workspace-containers can have floating clients */
+    TAILQ_HEAD(floating_head, Con) floating_head;
+
+    TAILQ_HEAD(nodes_head, Con) nodes_head;
+    TAILQ_HEAD(focus_head, Con) focus_head;
+
     TAILQ_ENTRY(Con) nodes;
     TAILQ_ENTRY(Con) focused;
-    TAILQ_ENTRY(Con) all_cons;
     TAILQ_ENTRY(Con) floating_windows;
 
+    /* The X11 state of this container's frame, see x.c. Set by x_con_init()
+     * so that x_push_node() does not need to search for it. */
+    struct con_state *state;
+
+    /** Cache for the decoration rendering, only meaningful if
+     * deco_render_params_valid is set. Stored inline so that
+     * x_draw_decoration() does not allocate. */
+    struct deco_render_params deco_render_params;
+    bool deco_render_params_valid;
+
+    /* The surface used for the frame window. */
+    surface_t frame;
+    surface_t frame_buffer;
+    bool pixmap_recreated;
+
+    /** This counter contains the number of UnmapNotify events for this
+     * container (or, more precisely, for its ->frame) which should be ignored.
+     * UnmapNotify events need to be ignored when they are caused by i3 itself,
+     * for example when reparenting or when unmapping the window on a workspace
+     * change. */
+    uint8_t ignore_unmap;
+
+    /* Depth of the container window */
+    uint16_t depth;
+
+    char *name;
+
+    /* The ID of this container as used in IPC replies and by the con_id
+     * criterion. It is a handle into a slot table and never reused, even when
+     * the memory of this container is. See con_by_con_id(). */
+    uint64_t id;
+
+    TAILQ_ENTRY(Con) all_cons;
+
     /** callbacks */
     void (*on_remove_child)(Con *);
 
@@ -760,13 +827,12 @@ struct Con {
         SCRATCHPAD_CHANGED = 2
     } scratchpad_state;
 
-    /* The ID of this container before restarting. Necessary to correctly
-     * interpret back-references in the JSON (such as the focus stack). */
-    int old_id;
-
-    /* Depth of the container window */
-    uint16_t depth;
-
-    /* The colormap for this con if a custom one is used. */
-    xcb_colormap_t colormap;
+    struct con_cold *cold;
 };
+
+/* The structures which are allocated and freed all the time are taken from
+ * pools, see create_struct(). */
+POOLED_STRUCT(Con);
+POOLED_STRUCT(con_cold);
+POOLED_STRUCT(Match);
+POOLED_STRUCT(mark_t);
@@ -0,0 +1,99 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved dynamic tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * hashtable.c: Small open-addressing hash tables used to index the layout
+ *              tree (for example X11 window IDs to containers).
+ *
+ */
+#pragma once
+
+#include <config.hpp>
+
+/**
+ * Maps non-zero 32 bit keys (such as xcb_window_t) to pointers. Uses linear
+ * probing with backward-shift deletion, so there are no tombstones and lookups
+ * stay short even with lots of churn. The key 0 (XCB_NONE) marks an empty slot
+ * and can therefore not be stored.
+ *
+ * A zero-initialized id_table_t is a valid, empty table.
+ *
+ */
+typedef struct id_table {
+    uint32_t *keys;
+    void **values;
+    /* Always 0 or a power of two. */
+    uint32_t capacity;
+    uint32_t count;
+} id_table_t;
+
+/**
+ * Inserts (or replaces) the value for the given key.
+ *
+ */
+void id_table_insert(id_table_t *table, uint32_t key, void *value);
+
+/**
+ * Returns the value stored for the given key or NULL if there is none.
+ *
+ */
+void *id_table_lookup(const id_table_t *table, uint32_t key);
+
+/**
+ * Removes the given key from the table. Returns the value which was stored for
+ * it or NULL if the key was not present.
+ *
+ */
+void *id_table_remove(id_table_t *table, uint32_t key);
+
+/**
+ * Frees all memory used by the table and resets it to an empty table.
+ *
+ */
+void id_table_free(id_table_t *table);
+
+/**
+ * Maps non-empty strings to pointers, with the same probing scheme as
+ * id_table_t. The table does not copy the keys: a key must stay valid (and
+ * unchanged) for as long as it is stored, which is usually done by using a
+ * string owned by the value as the key.
+ *
+ * A zero-initialized str_table_t is a valid, empty table.
+ *
+ */
+typedef struct str_table {
+    const char **keys;
+    uint32_t *hashes;
+    void **values;
+    /* Always 0 or a power of two. */
+    uint32_t capacity;
+    uint32_t count;
+} str_table_t;
+
+/**
+ * Inserts (or replaces) the value for the given key.
+ *
+ */
+void str_table_insert(str_table_t *table, const char *key, void *value);
+
+/**
+ * Returns the value stored for the given key or NULL if there is none.
+ *
+ */
+void *str_table_lookup(const str_table_t *table, const char *key);
+
+/**
+ * Removes the given key from the table. Returns the value which was stored for
+ * it or NULL if the key was not present.
+ *
+ */
+void *str_table_remove(str_table_t *table, const char *key);
+
+/**
+ * Frees all memory used by the table (but not the keys) and resets it to an
+ * empty table.
+ *
+ */
+void str_table_free(str_table_t *table);
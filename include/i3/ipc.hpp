@@ -69,6 +69,12 @@ typedef struct i3_ipc_header {
 /** Request the current binding state. */
 #define I3_IPC_MESSAGE_TYPE_GET_BINDING_STATE 12
 
+/** Requests the tree layout from i3 together with its generation */
+#define I3_IPC_MESSAGE_TYPE_GET_TREE_SNAPSHOT 13
+
+/** Request the allocation counters of the memory pools. */
+#define I3_IPC_MESSAGE_TYPE_GET_POOL_STATS 14
+
 /*
  * Messages from i3 to clients
  *
@@ -86,6 +92,8 @@ typedef struct i3_ipc_header {
 #define I3_IPC_REPLY_TYPE_TICK 10
 #define I3_IPC_REPLY_TYPE_SYNC 11
 #define I3_IPC_REPLY_TYPE_GET_BINDING_STATE 12
+#define I3_IPC_REPLY_TYPE_TREE_SNAPSHOT 13
+#define I3_IPC_REPLY_TYPE_POOL_STATS 14
 
 /*
  * Events from i3 to clients. Events have the first bit set high.
@@ -116,3 +124,7 @@ typedef struct i3_ipc_header {
 
 /** The tick event will be sent upon a tick IPC message */
 #define I3_IPC_EVENT_TICK (I3_IPC_EVENT_MASK | 7)
+
+/** The tree event will be triggered once per tree generation in which the
+ * layout tree changed */
+#define I3_IPC_EVENT_TREE (I3_IPC_EVENT_MASK | 8)
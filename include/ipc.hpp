@@ -23,22 +23,60 @@
 
 extern char *current_socketpath;
 
+/* Returns the bit of the given event type (I3_IPC_EVENT_*) in
+ * ipc_client.events. */
+#define IPC_EVENT_BIT(message_type) (1U << ((message_type) & ~I3_IPC_EVENT_MASK))
+
+/* A serialized message (header and payload). Events are serialized once and
+ * the same message is queued for every subscribed client, so a message is
+ * freed when the last client has sent it. */
+typedef struct ipc_message {
+    int refcount;
+    /* Whether this is an event (as opposed to a reply). */
+    bool event;
+    size_t size;
+    uint8_t *data;
+} ipc_message;
+
+/* An entry in the queue of messages which still have to be sent to a client. */
+typedef struct ipc_pending_message {
+    ipc_message *message;
+
+    TAILQ_ENTRY(ipc_pending_message) pending;
+} ipc_pending_message;
+
 typedef struct ipc_client {
     int fd;
 
-    /* The events which this client wants to receive */
-    int num_events;
-    char **events;
+    /* The events which this client wants to receive, see IPC_EVENT_BIT(). */
+    uint32_t events;
 
     /* For clients which subscribe to the tick event: whether the first tick
      * event has been sent by i3. */
     bool first_tick_sent;
 
+    /* Data received from the client which has not been handled yet: an
+     * incomplete message, for which input_capacity bytes are allocated. */
+    uint8_t *input;
+    size_t input_size;
+    size_t input_capacity;
+
     struct ev_io *read_callback;
     struct ev_io *write_callback;
     struct ev_timer *timeout;
-    uint8_t *buffer;
-    size_t buffer_size;
+
+    /* Messages which have not been (completely) sent yet. The first
+     * pending_offset bytes of the first message have already been written,
+     * pending_size is the number of bytes left to write and
+     * pending_event_size the part of it which belongs to events. */
+    TAILQ_HEAD(ipc_pending_head, ipc_pending_message) pending;
+    size_t pending_offset;
+    size_t pending_size;
+    size_t pending_event_size;
+
+    /* Set when the client went over the high-water mark. Nothing is written
+     * to it anymore and its timeout disconnects it. */
+    bool killed;
 
     TAILQ_ENTRY(ipc_client) clients;
 } ipc_client;
@@ -80,12 +118,20 @@ void ipc_new_client(EV_P_ struct ev_io *w, int revents);
  */
 ipc_client *ipc_new_client_on_fd(EV_P_ int fd);
 
+/**
+ * Returns true if at least one IPC client is subscribed to the given event
+ * type (I3_IPC_EVENT_*). Callers can use this to avoid generating events
+ * nobody will receive.
+ *
+ */
+bool ipc_has_subscribers(uint32_t message_type);
+
 /**
  * Sends the specified event to all IPC clients which are currently connected
  * and subscribed to this kind of event.
  *
  */
-void ipc_send_event(const char *event, uint32_t message_type, const char *payload);
+void ipc_send_event(uint32_t message_type, const char *payload);
 
 /**
  * Calls to ipc_shutdown() should provide a reason for the shutdown.
@@ -106,6 +152,13 @@ void ipc_shutdown(shutdown_reason_t reason, int exempt_fd);
 
 void dump_node(yajl_gen gen, Con *con, bool inplace_restart);
 
+/**
+ * Like dump_node(), but without the "nodes" and "floating_nodes" of the
+ * container.
+ *
+ */
+void dump_node_shallow(yajl_gen gen, Con *con);
+
 /**
  * Generates a json workspace event. Returns a dynamically allocated yajl
  * generator. Free with yajl_gen_free().
@@ -141,6 +194,12 @@ void ipc_send_binding_event(const char *event_type, Binding *bind);
  */
 void ipc_set_kill_timeout(ev_tstamp new);
 
+/**
+ * Set the maximum number of bytes which may be queued for a client before it
+ * is disconnected when sending it an event. 0 means no limit.
+ */
+void ipc_set_high_water_mark(size_t bytes);
+
 /**
  * Sends a restart reply to the IPC client on the specified fd.
  */
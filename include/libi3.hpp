@@ -441,17 +441,13 @@ void set_font_colors(xcb_gcontext_t gc, color_t foreground, color_t background);
 bool font_is_pango(void);
 
 /**
- * Draws text onto the specified X drawable (normally a pixmap) at the
- * specified coordinates (from the top left corner of the leftmost, uppermost
- * glyph) and using the provided gc.
- *
- * The given cairo surface must refer to the specified X drawable.
+ * Draws text onto the specified surface at the specified coordinates (from the
+ * top left corner of the leftmost, uppermost glyph).
  *
  * Text must be specified as an i3String.
  *
  */
-void draw_text(i3String *text, xcb_drawable_t drawable, xcb_gcontext_t gc,
-               cairo_surface_t *surface, int x, int y, int max_width);
+void draw_text(i3String *text, struct surface_t *surface, int x, int y, int max_width);
 
 /**
  * Predict the text width in pixels for the given text. Text must be
@@ -460,6 +456,13 @@ void draw_text(i3String *text, xcb_drawable_t drawable, xcb_gcontext_t gc,
  */
 int predict_text_width(i3String *text);
 
+/**
+ * Returns how many predict_text_width() calls were answered from the text
+ * width cache (hits) and how many had to lay out the text (misses).
+ *
+ */
+void text_width_cache_stats(unsigned long *hits, unsigned long *misses);
+
 /**
  * Returns the visual type associated with the given screen.
  *
@@ -575,8 +578,31 @@ typedef struct surface_t {
     /* The cairo object representing the drawable. In general,
      * this is what one should use for any drawing operation. */
     cairo_t *cr;
+
+    /* The Pango layout used to draw text with cr, created on first use and
+     * whenever the font changes (see draw_text()). */
+    PangoLayout *layout;
+    unsigned int layout_generation;
 } surface_t;
 
+/* Maximum number of rectangles a rect_batch_t holds before it is flushed. */
+#define RECT_BATCH_SIZE 32
+
+/* Filled rectangles which are collected and then drawn onto a surface with
+ * one fill per color, see draw_util_batch_rectangle(). */
+typedef struct rect_batch_t {
+    surface_t *surface;
+
+    int count;
+    struct {
+        color_t color;
+        double x;
+        double y;
+        double w;
+        double h;
+    } rects[RECT_BATCH_SIZE];
+} rect_batch_t;
+
 /**
  * Initialize the surface to represent the given drawable.
  *
@@ -624,6 +650,28 @@ void draw_util_image(cairo_surface_t *image, surface_t *surface, int x, int y, i
  */
 void draw_util_rectangle(surface_t *surface, color_t color, double x, double y, double w, double h);
 
+/**
+ * Starts a batch of rectangles which will be drawn onto the given surface.
+ *
+ */
+void draw_util_batch_begin(rect_batch_t *batch, surface_t *surface);
+
+/**
+ * Adds a filled rectangle to the batch. It is only drawn once the batch is
+ * flushed (which happens automatically when the batch is full), so anything
+ * that has to be drawn on top of it must wait for draw_util_batch_flush().
+ *
+ */
+void draw_util_batch_rectangle(rect_batch_t *batch, color_t color, double x, double y, double w, double h);
+
+/**
+ * Draws all rectangles of the batch, with one fill for each color, and empties
+ * the batch. The result is the same as drawing the rectangles one after the
+ * other with draw_util_rectangle().
+ *
+ */
+void draw_util_batch_flush(rect_batch_t *batch);
+
 /**
  * Clears a surface with the given color.
  *
@@ -7,11 +7,152 @@
  */
 #pragma once
 
+#include <err.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include <new>
+#include <type_traits>
+
+/**
+ * Allocation counters of a pool (see POOLED_STRUCT). All pools are linked
+ * together starting at pool_stats_head().
+ *
+ */
+struct pool_stats {
+    const char *name;
+    /* Number of objects currently handed out and on the free list. */
+    size_t in_use;
+    size_t free;
+    /* Total number of allocations and how many of them were served from the
+     * free list. */
+    size_t allocations;
+    size_t reused;
+    /* Number of slabs requested from malloc(). */
+    size_t slabs;
+
+    struct pool_stats *next;
+};
+
+inline struct pool_stats *&pool_stats_head() {
+    static struct pool_stats *head = nullptr;
+    return head;
+}
+
+/**
+ * Types declared with POOLED_STRUCT() are allocated by create_struct() from a
+ * per-type pool: objects are carved out of slabs and freed objects are kept on
+ * a free list for reuse instead of being returned to malloc(). This keeps
+ * frequently churned objects (containers, matches, …) close together and makes
+ * allocating them cheap.
+ *
+ * Pooled objects must be freed with destroy_struct() (or FREE_STRUCT()), never
+ * with free().
+ *
+ */
+template<typename DataType>
+struct pooled_struct : std::false_type {};
+
+#define POOLED_STRUCT(DataType)                         \
+    template<>                                          \
+    struct pooled_struct<DataType> : std::true_type {   \
+        static const char *name() { return #DataType; } \
+    }
+
+template<typename DataType>
+class Pool {
+    union Slot {
+        Slot *next;
+        alignas(DataType) unsigned char data[sizeof(DataType)];
+    };
+
+    /* Number of objects per slab. */
+    static const size_t SLAB_SIZE = 64;
+
+    static Slot *&free_list() {
+        static Slot *head = nullptr;
+        return head;
+    }
+
+   public:
+    static struct pool_stats &stats() {
+        static struct pool_stats *stats = []() {
+            struct pool_stats *s = new pool_stats{};
+            s->name = pooled_struct<DataType>::name();
+            s->next = pool_stats_head();
+            pool_stats_head() = s;
+            return s;
+        }();
+        return *stats;
+    }
+
+    /**
+     * Returns zeroed memory for one object.
+     *
+     */
+    static void *allocate() {
+        struct pool_stats &s = stats();
+        Slot *slot = free_list();
+        if (slot == nullptr) {
+            Slot *slab = static_cast<Slot *>(malloc(sizeof(Slot) * SLAB_SIZE));
+            if (slab == nullptr)
+                err(EXIT_FAILURE, "malloc(%zu)", sizeof(Slot) * SLAB_SIZE);
+            for (size_t i = 1; i < SLAB_SIZE - 1; i++)
+                slab[i].next = &slab[i + 1];
+            slab[SLAB_SIZE - 1].next = nullptr;
+            free_list() = &slab[1];
+            s.free += SLAB_SIZE - 1;
+            s.slabs++;
+            slot = &slab[0];
+        } else {
+            free_list() = slot->next;
+            s.free--;
+            s.reused++;
+        }
+        s.allocations++;
+        s.in_use++;
+        memset(slot, 0, sizeof(Slot));
+        return slot;
+    }
+
+    /**
+     * Puts the memory of an object (which has already been destroyed) back on
+     * the free list.
+     *
+     */
+    static void release(void *mem) {
+        struct pool_stats &s = stats();
+        Slot *slot = static_cast<Slot *>(mem);
+        slot->next = free_list();
+        free_list() = slot;
+        s.in_use--;
+        s.free++;
+    }
+};
+
+template<typename DataType>
+void *struct_alloc(std::true_type) {
+    return Pool<DataType>::allocate();
+}
+
+template<typename DataType>
+void *struct_alloc(std::false_type) {
+    return malloc(sizeof(DataType));
+}
+
+template<typename DataType>
+void struct_free(void *mem, std::true_type) {
+    Pool<DataType>::release(mem);
+}
+
+template<typename DataType>
+void struct_free(void *mem, std::false_type) {
+    free(mem);
+}
 
 template<typename DataType>
 DataType *create_struct() {
-  auto mem = malloc(sizeof(DataType));
+  auto mem = struct_alloc<DataType>(pooled_struct<DataType>());
   return new (mem) DataType{};
 }
 template<typename DataType>
@@ -19,3 +160,22 @@ DataType *create_struct(const std::size_t size) {
   auto mem = malloc(sizeof(DataType)*size);
   return static_cast<DataType*>(new (mem) DataType[size]);
 }
+
+/**
+ * Destroys and frees an object allocated with create_struct(). Does nothing
+ * for NULL.
+ *
+ */
+template<typename DataType>
+void destroy_struct(DataType *ptr) {
+    if (ptr == nullptr)
+        return;
+    ptr->~DataType();
+    struct_free<DataType>(ptr, pooled_struct<DataType>());
+}
+
+#define FREE_STRUCT(pointer)     \
+    do {                         \
+        destroy_struct(pointer); \
+        pointer = NULL;          \
+    } while (0)
@@ -58,6 +58,23 @@ bool level_down(void);
  */
 void tree_render(void);
 
+/**
+ * Requests a tree_render() without doing it right away. All requests made
+ * while handling one batch of X11 events (or one IPC message) are coalesced
+ * into a single render, which happens in tree_flush_render().
+ *
+ */
+void tree_request_render(void);
+
+/**
+ * Performs the render requested with tree_request_render(), if any. Called at
+ * the end of every event loop iteration and before anything which needs the
+ * tree to be visible in X11 already (like replies to the sync protocol).
+ * Returns true if a render happened.
+ *
+ */
+bool tree_flush_render(void);
+
 /**
  * Changes focus in the given direction
  *
@@ -0,0 +1,72 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved dynamic tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * tree_delta.c: Records changes to the layout tree and sends them to IPC
+ *               clients as "tree" events.
+ *
+ */
+#pragma once
+
+#include <config.hpp>
+
+/**
+ * Properties of a container whose changes are reported in "tree" events. The
+ * names are listed in the event (see tree_delta_flush()).
+ *
+ */
+typedef enum {
+    TREE_DELTA_NAME = (1 << 0),
+    TREE_DELTA_LAYOUT = (1 << 1),
+    TREE_DELTA_FOCUS = (1 << 2),
+    TREE_DELTA_URGENT = (1 << 3),
+    TREE_DELTA_MARKS = (1 << 4),
+    TREE_DELTA_FULLSCREEN = (1 << 5),
+    TREE_DELTA_FLOATING = (1 << 6),
+    TREE_DELTA_BORDER = (1 << 7),
+    TREE_DELTA_STICKY = (1 << 8),
+    TREE_DELTA_WINDOW_PROPERTIES = (1 << 9),
+} tree_delta_property_t;
+
+/**
+ * Records that the container was inserted into the child lists of
+ * con->parent. Containers which are attached for the first time are reported
+ * as new nodes.
+ *
+ */
+void tree_delta_attached(Con *con);
+
+/**
+ * Records that the children of the container (nodes, floating nodes or their
+ * order) changed.
+ *
+ */
+void tree_delta_children(Con *con);
+
+/**
+ * Records that the given property of the container changed.
+ *
+ */
+void tree_delta_property(Con *con, tree_delta_property_t property);
+
+/**
+ * Records that the container is about to be freed.
+ *
+ */
+void tree_delta_freed(Con *con);
+
+/**
+ * Starts a new tree generation if anything changed since the last call and
+ * sends the recorded changes to the clients subscribed to the "tree" event.
+ *
+ */
+void tree_delta_flush(void);
+
+/**
+ * Returns the current tree generation. Call tree_delta_flush() first to
+ * include changes which have not been sent yet.
+ *
+ */
+uint64_t tree_delta_generation(void);
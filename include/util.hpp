@@ -118,6 +118,13 @@ void exec_i3_utility(char *name, char *argv[]);
  */
 bool path_exists(const char *path);
 
+/**
+ * Logs the allocation counters of all memory pools (see create_struct()) and
+ * of the text width cache.
+ *
+ */
+void log_pool_stats(void);
+
 /**
  * Restart i3 in-place
  * appends -a to argument list to disable autostart
@@ -107,3 +107,12 @@ void window_update_machine(i3Window *win, xcb_get_property_reply_t *prop);
  *
  */
 void window_update_icon(i3Window *win, xcb_get_property_reply_t *prop);
+
+/**
+ * Returns the window icon scaled to fit into a square of the given size (the
+ * icon size in the decoration). The scaled icon is kept, so that the icon is
+ * only scaled again when it changes or the size does (because of a different
+ * decoration height or DPI), not on every redraw.
+ *
+ */
+cairo_surface_t *window_get_scaled_icon(i3Window *win, int size);
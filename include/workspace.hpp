@@ -31,6 +31,14 @@
  */
 extern char *previous_workspace_name;
 
+/**
+ * Marks the workspace index as outdated. Needs to be called whenever a
+ * workspace (or output) is added to or removed from the tree, and when a
+ * workspace is renamed.
+ *
+ */
+void workspace_invalidate_index(void);
+
 /**
  * Returns the workspace with the given name or NULL if such a workspace does
  * not exist.
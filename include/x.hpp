@@ -67,6 +67,21 @@ bool window_supports_protocol(xcb_window_t window, xcb_atom_t atom);
  */
 void x_window_kill(xcb_window_t window, kill_window_t kill_window);
 
+/**
+ * Copies the given region (relative to the frame) of the container's frame
+ * buffer to its frame, for example because it was exposed.
+ *
+ */
+void x_repaint_region(Con *con, Rect region);
+
+/**
+ * Makes the next x_draw_decoration() of the container render its title bar
+ * again instead of reusing the title strip, for example because the window
+ * icon changed.
+ *
+ */
+void x_invalidate_title_strip(Con *con);
+
 /**
  * Draws the decoration of the given container onto its parent.
  *
@@ -142,3 +157,22 @@ void x_mask_event_mask(uint32_t mask);
  * Enables or disables nonrectangular shape of the container frame.
  */
 void x_set_shape(Con *con, xcb_shape_sk_t kind, bool enable);
+
+/**
+ * Frame copy counters of x_push_changes() (sizes assume 32 bits per pixel).
+ *
+ */
+typedef struct x_frame_copy_stats {
+    uint64_t pushes;
+    uint64_t regions;
+    uint64_t bytes;
+    uint64_t last_regions;
+    uint64_t last_bytes;
+} x_frame_copy_stats_t;
+
+/**
+ * Returns the number of frame buffer regions copied to frames and their size
+ * in bytes, in total and for the last push.
+ *
+ */
+void x_frame_copy_stats(x_frame_copy_stats_t *stats);
@@ -51,6 +51,8 @@ void draw_util_surface_init(xcb_connection_t *conn, surface_t *surface, xcb_draw
 
     surface->surface = cairo_xcb_surface_create(conn, surface->id, visual, width, height);
     surface->cr = cairo_create(surface->surface);
+    surface->layout = NULL;
+    surface->layout_generation = 0;
 }
 
 /*
@@ -59,6 +61,8 @@ void draw_util_surface_init(xcb_connection_t *conn, surface_t *surface, xcb_draw
  */
 void draw_util_surface_free(xcb_connection_t *conn, surface_t *surface) {
     xcb_free_gc(conn, surface->gc);
+    if (surface->layout != NULL)
+        g_object_unref(surface->layout);
     cairo_surface_destroy(surface->surface);
     cairo_destroy(surface->cr);
 
@@ -67,6 +71,7 @@ void draw_util_surface_free(xcb_connection_t *conn, surface_t *surface) {
      * when setting the border of a window to none and then closing it. */
     surface->surface = NULL;
     surface->cr = NULL;
+    surface->layout = NULL;
 }
 
 /*
@@ -135,7 +140,7 @@ void draw_util_text(i3String *text, surface_t *surface, color_t fg_color, color_
     CAIRO_SURFACE_FLUSH(surface->surface);
 
     set_font_colors(surface->gc, fg_color, bg_color);
-    draw_text(text, surface->id, surface->gc, surface->surface, x, y, max_width);
+    draw_text(text, surface, x, y, max_width);
 
     /* Notify cairo that we (possibly) used another way to draw on the surface. */
     cairo_surface_mark_dirty(surface->surface);
@@ -192,6 +197,116 @@ void draw_util_rectangle(surface_t *surface, color_t color, double x, double y,
     cairo_restore(surface->cr);
 }
 
+/*
+ * Starts a batch of rectangles which will be drawn onto the given surface.
+ *
+ */
+void draw_util_batch_begin(rect_batch_t *batch, surface_t *surface) {
+    batch->surface = surface;
+    batch->count = 0;
+}
+
+/*
+ * Adds a filled rectangle to the batch. It is only drawn once the batch is
+ * flushed (which happens automatically when the batch is full), so anything
+ * that has to be drawn on top of it must wait for draw_util_batch_flush().
+ *
+ */
+void draw_util_batch_rectangle(rect_batch_t *batch, color_t color, double x, double y, double w, double h) {
+    if (batch->count == RECT_BATCH_SIZE)
+        draw_util_batch_flush(batch);
+
+    /* All rectangles of one path need the same orientation, otherwise
+     * overlapping parts would cancel out with the nonzero fill rule. */
+    if (w < 0) {
+        x += w;
+        w = -w;
+    }
+    if (h < 0) {
+        y += h;
+        h = -h;
+    }
+    if (w == 0 || h == 0)
+        return;
+
+    int i = batch->count++;
+    batch->rects[i].color = color;
+    batch->rects[i].x = x;
+    batch->rects[i].y = y;
+    batch->rects[i].w = w;
+    batch->rects[i].h = h;
+}
+
+static bool batch_same_color(rect_batch_t *batch, int a, int b) {
+    color_t *ca = &(batch->rects[a].color);
+    color_t *cb = &(batch->rects[b].color);
+    return (ca->red == cb->red && ca->green == cb->green &&
+            ca->blue == cb->blue && ca->alpha == cb->alpha);
+}
+
+static bool batch_overlap(rect_batch_t *batch, int a, int b) {
+    return (batch->rects[a].x < batch->rects[b].x + batch->rects[b].w &&
+            batch->rects[b].x < batch->rects[a].x + batch->rects[a].w &&
+            batch->rects[a].y < batch->rects[b].y + batch->rects[b].h &&
+            batch->rects[b].y < batch->rects[a].y + batch->rects[a].h);
+}
+
+/*
+ * Draws all rectangles of the batch, with one fill for each color, and empties
+ * the batch. The result is the same as drawing the rectangles one after the
+ * other with draw_util_rectangle().
+ *
+ */
+void draw_util_batch_flush(rect_batch_t *batch) {
+    if (batch->count == 0)
+        return;
+
+    surface_t *surface = batch->surface;
+    const int count = batch->count;
+    batch->count = 0;
+    RETURN_UNLESS_SURFACE_INITIALIZED(surface);
+
+    cairo_save(surface->cr);
+
+    /* Using the SOURCE operator will copy both color and alpha information directly
+     * onto the surface rather than blending it. This is a bit more efficient and
+     * allows better color control for the user when using opacity. */
+    cairo_set_operator(surface->cr, CAIRO_OPERATOR_SOURCE);
+
+    bool drawn[RECT_BATCH_SIZE] = {false};
+    for (int i = 0; i < count; i++) {
+        if (drawn[i])
+            continue;
+
+        draw_util_set_source_color(surface, batch->rects[i].color);
+        for (int j = i; j < count; j++) {
+            if (drawn[j] || !batch_same_color(batch, i, j))
+                continue;
+
+            /* Pulling the rectangle forward is only allowed if no rectangle
+             * of another color which is drawn later (but came first) would
+             * now paint over it. */
+            bool blocked = false;
+            for (int k = i + 1; k < j && !blocked; k++) {
+                blocked = (!drawn[k] && !batch_same_color(batch, i, k) && batch_overlap(batch, j, k));
+            }
+            if (blocked)
+                continue;
+
+            cairo_rectangle(surface->cr, batch->rects[j].x, batch->rects[j].y,
+                            batch->rects[j].w, batch->rects[j].h);
+            drawn[j] = true;
+        }
+        cairo_fill(surface->cr);
+    }
+
+    /* Make sure we flush the surface for any text drawing operations that could follow.
+     * Since we support drawing text via XCB, we need this. */
+    CAIRO_SURFACE_FLUSH(surface->surface);
+
+    cairo_restore(surface->cr);
+}
+
 /*
  * Clears a surface with the given color.
  *
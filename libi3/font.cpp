@@ -22,6 +22,166 @@ static double pango_font_red;
 static double pango_font_green;
 static double pango_font_blue;
 
+/* Incremented whenever the current font (or the DPI) changes, so that the
+ * PangoLayouts cached in surfaces (see surface_t) are recreated. Starts at 1
+ * because a zeroed surface_t has a layout_generation of 0. */
+static unsigned int layout_generation = 1;
+static long layout_dpi;
+
+/* Widths computed by predict_text_width_pango() are kept in a small LRU cache,
+ * keyed by font, markup flag and text. Laying out the text is expensive and
+ * the same titles, marks and status blocks are measured over and over. */
+#define TEXT_WIDTH_CACHE_SIZE 256
+/* Must be a power of two. */
+#define TEXT_WIDTH_CACHE_BUCKETS 512
+
+struct text_width_entry {
+    const i3Font *font;
+    /* A copy of the text, NULL if the entry is unused. */
+    char *text;
+    size_t text_len;
+    bool pango_markup;
+    uint32_t hash;
+    int width;
+
+    /* Index + 1 of the next entry in the same bucket, or 0. */
+    int bucket_next;
+    /* Index + 1 of the next more/less recently used entry, or 0. */
+    int lru_prev;
+    int lru_next;
+};
+
+static struct {
+    struct text_width_entry entries[TEXT_WIDTH_CACHE_SIZE];
+    /* Index + 1 of the first entry of each bucket, or 0. */
+    int buckets[TEXT_WIDTH_CACHE_BUCKETS];
+    int count;
+    /* Index + 1 of the most and least recently used entry, or 0. */
+    int lru_head;
+    int lru_tail;
+    /* The DPI the cached widths were computed with. */
+    long dpi;
+
+    unsigned long hits;
+    unsigned long misses;
+} text_width_cache;
+
+static uint32_t text_width_hash(const i3Font *font, const char *text, size_t text_len, bool pango_markup) {
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < text_len; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    hash ^= (uint32_t)(uintptr_t)font ^ (pango_markup ? 0x80000000u : 0);
+    hash *= 16777619u;
+    return hash;
+}
+
+/*
+ * Drops all cached widths, for example because the font they were computed
+ * with is freed.
+ *
+ */
+static void text_width_cache_flush(void) {
+    for (int i = 0; i < TEXT_WIDTH_CACHE_SIZE; i++) {
+        free(text_width_cache.entries[i].text);
+    }
+    memset(text_width_cache.entries, 0, sizeof(text_width_cache.entries));
+    memset(text_width_cache.buckets, 0, sizeof(text_width_cache.buckets));
+    text_width_cache.count = 0;
+    text_width_cache.lru_head = 0;
+    text_width_cache.lru_tail = 0;
+}
+
+static void text_width_cache_unlink(int idx) {
+    struct text_width_entry *entry = &(text_width_cache.entries[idx - 1]);
+    if (entry->lru_prev)
+        text_width_cache.entries[entry->lru_prev - 1].lru_next = entry->lru_next;
+    else
+        text_width_cache.lru_head = entry->lru_next;
+    if (entry->lru_next)
+        text_width_cache.entries[entry->lru_next - 1].lru_prev = entry->lru_prev;
+    else
+        text_width_cache.lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = 0;
+}
+
+static void text_width_cache_push_front(int idx) {
+    struct text_width_entry *entry = &(text_width_cache.entries[idx - 1]);
+    entry->lru_prev = 0;
+    entry->lru_next = text_width_cache.lru_head;
+    if (text_width_cache.lru_head)
+        text_width_cache.entries[text_width_cache.lru_head - 1].lru_prev = idx;
+    else
+        text_width_cache.lru_tail = idx;
+    text_width_cache.lru_head = idx;
+}
+
+/*
+ * Looks up the width of the given text. Returns true and moves the entry to
+ * the front of the LRU list if it is cached.
+ *
+ */
+static bool text_width_cache_get(const char *text, size_t text_len, bool pango_markup, uint32_t hash, int *width) {
+    int idx = text_width_cache.buckets[hash & (TEXT_WIDTH_CACHE_BUCKETS - 1)];
+    while (idx) {
+        struct text_width_entry *entry = &(text_width_cache.entries[idx - 1]);
+        if (entry->hash == hash &&
+            entry->font == savedFont &&
+            entry->pango_markup == pango_markup &&
+            entry->text_len == text_len &&
+            memcmp(entry->text, text, text_len) == 0) {
+            if (text_width_cache.lru_head != idx) {
+                text_width_cache_unlink(idx);
+                text_width_cache_push_front(idx);
+            }
+            *width = entry->width;
+            return true;
+        }
+        idx = entry->bucket_next;
+    }
+    return false;
+}
+
+/*
+ * Stores the width of the given text, evicting the least recently used entry
+ * if the cache is full.
+ *
+ */
+static void text_width_cache_put(const char *text, size_t text_len, bool pango_markup, uint32_t hash, int width) {
+    int idx;
+    if (text_width_cache.count < TEXT_WIDTH_CACHE_SIZE) {
+        idx = ++text_width_cache.count;
+    } else {
+        idx = text_width_cache.lru_tail;
+        struct text_width_entry *old = &(text_width_cache.entries[idx - 1]);
+        text_width_cache_unlink(idx);
+
+        int *link = &(text_width_cache.buckets[old->hash & (TEXT_WIDTH_CACHE_BUCKETS - 1)]);
+        while (*link != idx)
+            link = &(text_width_cache.entries[*link - 1].bucket_next);
+        *link = old->bucket_next;
+
+        free(old->text);
+    }
+
+    struct text_width_entry *entry = &(text_width_cache.entries[idx - 1]);
+    entry->font = savedFont;
+    entry->text = smalloc(text_len + 1);
+    memcpy(entry->text, text, text_len);
+    entry->text[text_len] = '\0';
+    entry->text_len = text_len;
+    entry->pango_markup = pango_markup;
+    entry->hash = hash;
+    entry->width = width;
+
+    int *bucket = &(text_width_cache.buckets[hash & (TEXT_WIDTH_CACHE_BUCKETS - 1)]);
+    entry->bucket_next = *bucket;
+    *bucket = idx;
+    text_width_cache_push_front(idx);
+}
+
 static PangoLayout *create_layout_with_dpi(cairo_t *cr) {
     PangoLayout *layout;
     PangoContext *context;
@@ -77,30 +237,56 @@ static bool load_pango_font(i3Font *font, const char *desc) {
     return true;
 }
 
+/*
+ * Returns the Pango layout of the surface, creating it (again) if there is
+ * none yet or the font or DPI changed since it was created.
+ *
+ */
+static PangoLayout *get_surface_layout(surface_t *surface) {
+    if (layout_dpi != get_dpi_value()) {
+        layout_dpi = get_dpi_value();
+        layout_generation++;
+    }
+
+    if (surface->layout != NULL && surface->layout_generation == layout_generation)
+        return surface->layout;
+
+    if (surface->layout != NULL)
+        g_object_unref(surface->layout);
+
+    surface->layout = create_layout_with_dpi(surface->cr);
+    surface->layout_generation = layout_generation;
+    pango_layout_set_font_description(surface->layout, savedFont->specific.pango_desc);
+    pango_layout_set_wrap(surface->layout, PANGO_WRAP_CHAR);
+    pango_layout_set_ellipsize(surface->layout, PANGO_ELLIPSIZE_END);
+
+    return surface->layout;
+}
+
 /*
  * Draws text using Pango rendering.
  *
  */
-static void draw_text_pango(const char *text, size_t text_len,
-                            xcb_drawable_t drawable, cairo_surface_t *surface,
+static void draw_text_pango(const char *text, size_t text_len, surface_t *surface,
                             int x, int y, int max_width, bool pango_markup) {
-    /* Create the Pango layout */
-    /* root_visual_type is cached in load_pango_font */
-    cairo_t *cr = cairo_create(surface);
-    PangoLayout *layout = create_layout_with_dpi(cr);
+    /* The cairo context and the layout live as long as the surface, so we only
+     * need to update the per-call state. */
+    cairo_t *cr = surface->cr;
+    PangoLayout *layout = get_surface_layout(surface);
     gint height;
 
-    pango_layout_set_font_description(layout, savedFont->specific.pango_desc);
     pango_layout_set_width(layout, max_width * PANGO_SCALE);
-    pango_layout_set_wrap(layout, PANGO_WRAP_CHAR);
-    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
 
-    if (pango_markup)
+    if (pango_markup) {
         pango_layout_set_markup(layout, text, text_len);
-    else
+    } else {
+        /* Drop the attributes of any markup previously drawn. */
+        pango_layout_set_attributes(layout, NULL);
         pango_layout_set_text(layout, text, text_len);
+    }
 
     /* Do the drawing */
+    cairo_save(cr);
     cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
     cairo_set_source_rgb(cr, pango_font_red, pango_font_green, pango_font_blue);
     pango_cairo_update_layout(cr, layout);
@@ -109,10 +295,8 @@ static void draw_text_pango(const char *text, size_t text_len,
     int yoffset = (height - savedFont->height) / 2;
     cairo_move_to(cr, x, y - yoffset);
     pango_cairo_show_layout(cr, layout);
-
-    /* Free resources */
-    g_object_unref(layout);
-    cairo_destroy(cr);
+    cairo_new_path(cr);
+    cairo_restore(cr);
 }
 
 /*
@@ -120,6 +304,20 @@ static void draw_text_pango(const char *text, size_t text_len,
  *
  */
 static int predict_text_width_pango(const char *text, size_t text_len, bool pango_markup) {
+    /* The cached widths depend on the DPI, too. */
+    if (text_width_cache.dpi != get_dpi_value()) {
+        text_width_cache_flush();
+        text_width_cache.dpi = get_dpi_value();
+    }
+
+    const uint32_t hash = text_width_hash(savedFont, text, text_len, pango_markup);
+    int cached_width;
+    if (text_width_cache_get(text, text_len, pango_markup, hash, &cached_width)) {
+        text_width_cache.hits++;
+        return cached_width;
+    }
+    text_width_cache.misses++;
+
     /* Create a dummy Pango layout */
     /* root_visual_type is cached in load_pango_font */
     cairo_surface_t *surface = cairo_xcb_surface_create(conn, root_screen->root, root_visual_type, 1, 1);
@@ -143,6 +341,8 @@ static int predict_text_width_pango(const char *text, size_t text_len, bool pang
     cairo_destroy(cr);
     cairo_surface_destroy(surface);
 
+    text_width_cache_put(text, text_len, pango_markup, hash, width);
+
     return width;
 }
 
@@ -247,6 +447,8 @@ i3Font load_font(const char *pattern, const bool fallback) {
  *
  */
 void set_font(i3Font *font) {
+    if (font != savedFont)
+        layout_generation++;
     savedFont = font;
 }
 
@@ -260,6 +462,10 @@ void free_font(void) {
     if (savedFont == NULL)
         return;
 
+    /* The font might be loaded again at the same address, see load_font(). */
+    text_width_cache_flush();
+    layout_generation++;
+
     free(savedFont->pattern);
     switch (savedFont->type) {
         case FONT_TYPE_NONE:
@@ -347,15 +553,13 @@ static void draw_text_xcb(const xcb_char2b_t *text, size_t text_len, xcb_drawabl
 }
 
 /*
- * Draws text onto the specified X drawable (normally a pixmap) at the
- * specified coordinates (from the top left corner of the leftmost, uppermost
- * glyph) and using the provided gc.
+ * Draws text onto the specified surface at the specified coordinates (from the
+ * top left corner of the leftmost, uppermost glyph).
  *
  * Text must be specified as an i3String.
  *
  */
-void draw_text(i3String *text, xcb_drawable_t drawable, xcb_gcontext_t gc,
-               cairo_surface_t *surface, int x, int y, int max_width) {
+void draw_text(i3String *text, surface_t *surface, int x, int y, int max_width) {
     assert(savedFont != NULL);
 
     switch (savedFont->type) {
@@ -364,12 +568,12 @@ void draw_text(i3String *text, xcb_drawable_t drawable, xcb_gcontext_t gc,
             return;
         case FONT_TYPE_XCB:
             draw_text_xcb(i3string_as_ucs2(text), i3string_get_num_glyphs(text),
-                          drawable, gc, x, y);
+                          surface->id, surface->gc, x, y);
             break;
         case FONT_TYPE_PANGO:
             /* Render the text using Pango */
             draw_text_pango(i3string_as_utf8(text), i3string_get_num_bytes(text),
-                            drawable, surface, x, y, max_width, i3string_is_markup(text));
+                            surface, x, y, max_width, i3string_is_markup(text));
             return;
     }
 }
@@ -467,3 +671,13 @@ int predict_text_width(i3String *text) {
     }
     assert(false);
 }
+
+/*
+ * Returns how many predict_text_width() calls were answered from the text
+ * width cache (hits) and how many had to lay out the text (misses).
+ *
+ */
+void text_width_cache_stats(unsigned long *hits, unsigned long *misses) {
+    *hits = text_width_cache.hits;
+    *misses = text_width_cache.misses;
+}
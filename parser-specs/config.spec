@@ -51,6 +51,7 @@ state INITIAL:
   'workspace'                              -> WORKSPACE
   'ipc_socket', 'ipc-socket'               -> IPC_SOCKET
   'ipc_kill_timeout'                       -> IPC_KILL_TIMEOUT
+  'ipc_high_water_mark'                    -> IPC_HIGH_WATER_MARK
   'restart_state'                          -> RESTART_STATE
   'popup_during_fullscreen'                -> POPUP_DURING_FULLSCREEN
   exectype = 'exec_always', 'exec'         -> EXEC
@@ -320,6 +321,11 @@ state IPC_KILL_TIMEOUT:
   timeout = number
       -> call cfg_ipc_kill_timeout(&timeout)
 
+# ipc_high_water_mark <bytes>
+state IPC_HIGH_WATER_MARK:
+  bytes = number
+      -> call cfg_ipc_high_water_mark(&bytes)
+
 # restart_state <path> (for testcases)
 state RESTART_STATE:
   path = string
@@ -641,12 +641,14 @@ void switch_mode(const char *new_mode) {
                 bind->release = Binding::B_UPON_KEYRELEASE;
         }
 
-        char *event_msg;
-        sasprintf(&event_msg, "{\"change\":\"%s\", \"pango_markup\":%s}",
-                  mode->name, (mode->pango_markup ? "true" : "false"));
+        if (ipc_has_subscribers(I3_IPC_EVENT_MODE)) {
+            char *event_msg;
+            sasprintf(&event_msg, "{\"change\":\"%s\", \"pango_markup\":%s}",
+                      mode->name, (mode->pango_markup ? "true" : "false"));
 
-        ipc_send_event("mode", I3_IPC_EVENT_MODE, event_msg);
-        FREE(event_msg);
+            ipc_send_event(I3_IPC_EVENT_MODE, event_msg);
+            FREE(event_msg);
+        }
 
         return;
     }
@@ -841,14 +843,14 @@ CommandResult *run_binding(Binding *bind, Con *con) {
     if (con == NULL)
         command = sstrdup(bind->command);
     else
-        sasprintf(&command, "[con_id=\"%p\"] %s", con, bind->command);
+        sasprintf(&command, "[con_id=\"%llu\"] %s", (unsigned long long)con->id, bind->command);
 
     Binding *bind_cp = binding_copy(bind);
     CommandResult *result = parse_command(command, NULL, NULL);
     free(command);
 
     if (result->needs_tree_render)
-        tree_render();
+        tree_request_render();
 
     if (result->parse_error) {
         char *pageraction;
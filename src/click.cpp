@@ -303,7 +303,7 @@ static void route_click(Con *con, xcb_button_press_event_t *event, const bool mo
 done:
     xcb_allow_events(conn, XCB_ALLOW_REPLAY_POINTER, event->time);
     xcb_flush(conn);
-    tree_render();
+    tree_request_render();
 }
 
 /*
@@ -355,7 +355,7 @@ void handle_button_press(xcb_button_press_event_t *event) {
                 ws = TAILQ_FIRST(&(output_get_content(output)->focus_head));
                 if (ws != con_get_workspace(focused)) {
                     workspace_show(ws);
-                    tree_render();
+                    tree_request_render();
                 }
                 return;
             }
@@ -44,6 +44,21 @@
         }                                               \
     } while (0)
 
+/*
+ * Helper data structure for an operation window (window on which the operation
+ * will be performed). Used to build the TAILQ owindows.
+ *
+ */
+typedef struct owindow {
+    Con *con;
+    TAILQ_ENTRY(owindow) owindows;
+} owindow;
+POOLED_STRUCT(owindow);
+
+typedef TAILQ_HEAD(owindows_head, owindow) owindows_head;
+
+static owindows_head owindows;
+
 namespace {
 /** If an error occurred during parsing of the criteria, we want to exit instead
  * of relying on fallback behavior. See #2091. */
@@ -69,9 +84,9 @@ bool handle_empty_match(Match *current_match) {
         while (!TAILQ_EMPTY(&owindows)) {          
             owindow *ow = TAILQ_FIRST(&owindows);  
             TAILQ_REMOVE(&owindows, ow, owindows); 
-            free(ow);                              
+            destroy_struct(ow);                    
         }                                          
-        owindow *ow = smalloc(sizeof(owindow));    
+        owindow *ow = create_struct<owindow>();    
         ow->con = focused;                         
         TAILQ_INIT(&owindows);                     
         TAILQ_INSERT_TAIL(&owindows, ow, owindows);
@@ -130,20 +145,6 @@ static Con *maybe_auto_back_and_forth_workspace(Con *workspace) {
  * Criteria functions.
  ******************************************************************************/
 
-/*
- * Helper data structure for an operation window (window on which the operation
- * will be performed). Used to build the TAILQ owindows.
- *
- */
-typedef struct owindow {
-    Con *con;
-    TAILQ_ENTRY(owindow) owindows;
-} owindow;
-
-typedef TAILQ_HEAD(owindows_head, owindow) owindows_head;
-
-static owindows_head owindows;
-
 /*
  * Initializes the specified 'Match' data structure and the initial state of
  * commands.c for matching target windows of a command.
@@ -159,12 +160,12 @@ void cmd_criteria_init(Match *current_match, CommandResultIR *cmd_output) {
     while (!TAILQ_EMPTY(&owindows)) {
         ow = TAILQ_FIRST(&owindows);
         TAILQ_REMOVE(&owindows, ow, owindows);
-        free(ow);
+        destroy_struct(ow);
     }
     TAILQ_INIT(&owindows);
     /* copy all_cons */
     TAILQ_FOREACH (con, &all_cons, all_cons) {
-        ow = smalloc(sizeof(owindow));
+        ow = create_struct<owindow>();
         ow->con = con;
         TAILQ_INSERT_TAIL(&owindows, ow, owindows);
     }
@@ -196,24 +197,24 @@ void cmd_criteria_match_windows(Match *current_match, CommandResultIR *cmd_outpu
          * only window-specific criteria were specified. */
         bool accept_match = false;
 
-        if (current_match->con_id != NULL) {
+        if (current_match->con_id != 0) {
             accept_match = true;
 
-            if (current_match->con_id == current->con) {
+            if (current_match->con_id == current->con->id) {
                 DLOG("con_id matched.\n");
             } else {
                 DLOG("con_id does not match.\n");
-                FREE(current);
+                FREE_STRUCT(current);
                 continue;
             }
         }
 
-        if (current_match->mark != NULL && !TAILQ_EMPTY(&(current->con->marks_head))) {
+        if (current_match->mark != NULL && !TAILQ_EMPTY(&(current->con->cold->marks_head))) {
             accept_match = true;
             bool matched_by_mark = false;
 
             mark_t *mark;
-            TAILQ_FOREACH (mark, &(current->con->marks_head), marks) {
+            TAILQ_FOREACH (mark, &(current->con->cold->marks_head), marks) {
                 if (!regex_matches(current_match->mark, mark->name))
                     continue;
 
@@ -224,7 +225,7 @@ void cmd_criteria_match_windows(Match *current_match, CommandResultIR *cmd_outpu
 
             if (!matched_by_mark) {
                 DLOG("mark does not match.\n");
-                FREE(current);
+                FREE_STRUCT(current);
                 continue;
             }
         }
@@ -235,7 +236,7 @@ void cmd_criteria_match_windows(Match *current_match, CommandResultIR *cmd_outpu
                 accept_match = true;
             } else {
                 DLOG("doesn't match\n");
-                FREE(current);
+                FREE_STRUCT(current);
                 continue;
             }
         }
@@ -243,7 +244,7 @@ void cmd_criteria_match_windows(Match *current_match, CommandResultIR *cmd_outpu
         if (accept_match) {
             TAILQ_INSERT_TAIL(&owindows, current, owindows);
         } else {
-            FREE(current);
+            FREE_STRUCT(current);
             continue;
         }
     }
@@ -1552,6 +1553,7 @@ void cmd_sticky(Match *current_match, CommandResultIR *cmd_output, const char *a
             sticky = !current->con->sticky;
 
         current->con->sticky = sticky;
+        tree_delta_property(current->con, TREE_DELTA_STICKY);
         ewmh_update_sticky(current->con->window->id, sticky);
     }
 
@@ -1574,6 +1576,7 @@ void cmd_move_direction(Match *current_match, CommandResultIR *cmd_output, const
     if(handle_empty_match(current_match)) { return; }
 
     Con *initially_focused = focused;
+    const uint64_t initially_focused_id = focused->id;
     direction_t direction = parse_direction(direction_str);
 
     const bool is_ppt = mode && strcmp(mode, "ppt") == 0;
@@ -1607,9 +1610,9 @@ void cmd_move_direction(Match *current_match, CommandResultIR *cmd_output, const
         }
     }
 
-    /* The move command should not disturb focus. con_exists is called because
-     * tree_move calls tree_flatten. */
-    if (focused != initially_focused && con_exists(initially_focused)) {
+    /* The move command should not disturb focus. The container is looked up
+     * again because tree_move calls tree_flatten. */
+    if (focused != initially_focused && con_by_con_id(initially_focused_id) != NULL) {
         con_activate(initially_focused);
     }
 
@@ -1762,7 +1765,7 @@ void cmd_open(Match *current_match, CommandResultIR *cmd_output) {
     ystr("success");
     y(bool, true);
     ystr("id");
-    y(integer, (uintptr_t)con);
+    y(integer, con->id);
     y(map_close);
 
     cmd_output->needs_tree_render = true;
@@ -2021,12 +2024,12 @@ void cmd_title_format(Match *current_match, CommandResultIR *cmd_output, const c
     owindow *current;
     TAILQ_FOREACH (current, &owindows, owindows) {
         DLOG("setting title_format for %p / %s\n", current->con, current->con->name);
-        FREE(current->con->title_format);
+        FREE(current->con->cold->title_format);
 
         /* If we only display the title without anything else, we can skip the parsing step,
          * so we remove the title format altogether. */
         if (strcasecmp(format, "%title") != 0) {
-            current->con->title_format = sstrdup(format);
+            current->con->cold->title_format = sstrdup(format);
 
             if (current->con->window != NULL) {
                 i3String *formatted_title = con_parse_title_format(current->con);
@@ -2045,7 +2048,7 @@ void cmd_title_format(Match *current_match, CommandResultIR *cmd_output, const c
             current->con->window->name_x_changed = true;
         } else {
             /* For windowless containers we also need to force the redrawing. */
-            FREE(current->con->deco_render_params);
+            current->con->deco_render_params_valid = false;
         }
     }
 
@@ -2069,14 +2072,14 @@ void cmd_title_window_icon(Match *current_match, CommandResultIR *cmd_output, co
     owindow *current;
     TAILQ_FOREACH (current, &owindows, owindows) {
         DLOG("setting window_icon for %p / %s\n", current->con, current->con->name);
-        current->con->window_icon_padding = padding;
+        current->con->cold->window_icon_padding = padding;
 
         if (current->con->window != NULL) {
             /* Make sure the window title is redrawn immediately. */
             current->con->window->name_x_changed = true;
         } else {
             /* For windowless containers we also need to force the redrawing. */
-            FREE(current->con->deco_render_params);
+            current->con->deco_render_params_valid = false;
         }
     }
 
@@ -2126,6 +2129,7 @@ void cmd_rename_workspace(Match *current_match, CommandResultIR *cmd_output, con
     char *old_name_copy = sstrdup(old_name);
     FREE(workspace->name);
     workspace->name = sstrdup(new_name);
+    tree_delta_property(workspace, TREE_DELTA_NAME);
 
     workspace->num = ws_name_to_number(new_name);
     LOG("num = %d\n", workspace->num);
@@ -14,6 +14,75 @@
 
 static void con_on_remove_child(Con *con);
 
+/* Indexes for con_by_window_id() and con_by_frame_id(), which are called for
+ * almost every X11 event and would otherwise have to walk all_cons. */
+static id_table_t cons_by_window;
+static id_table_t cons_by_frame;
+
+/* Container IDs (Con.id) are handles into this table: the low
+ * CON_ID_INDEX_BITS bits are the slot index + 1, the bits above are the
+ * generation of the slot, which is incremented whenever its container is
+ * freed. A stale ID therefore never resolves to a container which reuses the
+ * slot (or the memory). IDs stay below 2^53 so that JSON parsers using
+ * doubles get them right. */
+#define CON_ID_INDEX_BITS 24
+#define CON_ID_GENERATION_MASK ((1U << 29) - 1)
+
+struct con_slot {
+    Con *con;
+    uint32_t generation;
+    /* If the slot is free: index + 1 of the next free slot, or 0. */
+    uint32_t next_free;
+};
+static struct con_slot *con_slots = NULL;
+static uint32_t con_slots_count = 0;
+static uint32_t con_slots_size = 0;
+static uint32_t con_slots_free = 0;
+
+/*
+ * Assigns a new ID to the container.
+ *
+ */
+static void con_assign_id(Con *con) {
+    uint32_t index;
+    if (con_slots_free != 0) {
+        index = con_slots_free - 1;
+        con_slots_free = con_slots[index].next_free;
+    } else {
+        if (con_slots_count == con_slots_size) {
+            con_slots_size = (con_slots_size == 0 ? 256 : con_slots_size * 2);
+            con_slots = srealloc(con_slots, sizeof(struct con_slot) * con_slots_size);
+        }
+        index = con_slots_count++;
+        assert(con_slots_count < (1U << CON_ID_INDEX_BITS));
+        con_slots[index].generation = 0;
+    }
+
+    con_slots[index].con = con;
+    con_slots[index].next_free = 0;
+    con->id = ((uint64_t)con_slots[index].generation << CON_ID_INDEX_BITS) | (index + 1);
+}
+
+/*
+ * Invalidates the ID of the container (which is about to be freed).
+ *
+ */
+static void con_release_id(Con *con) {
+    uint32_t index = (con->id & ((1U << CON_ID_INDEX_BITS) - 1)) - 1;
+    struct con_slot *slot = &con_slots[index];
+    assert(slot->con == con);
+
+    slot->con = NULL;
+    slot->generation = (slot->generation + 1) & CON_ID_GENERATION_MASK;
+    slot->next_free = con_slots_free;
+    con_slots_free = index + 1;
+    con->id = 0;
+}
+
+/* Maps every mark to the container holding it (marks are unique). The keys are
+ * the names owned by the mark_t of the container. */
+static str_table_t cons_by_mark;
+
 /*
  * force parent split containers to be redrawn
  *
@@ -21,29 +90,59 @@ static void con_on_remove_child(Con *con);
 void con_force_split_parents_redraw(Con *con) {
     Con *parent = con;
 
+    /* Their titles may show the tree representation. */
+    con_invalidate_tree_representation(con);
+
     while (parent != NULL && parent->type != CT_WORKSPACE && parent->type != CT_DOCKAREA) {
         if (!con_is_leaf(parent)) {
-            FREE(parent->deco_render_params);
+            parent->deco_render_params_valid = false;
         }
 
         parent = parent->parent;
     }
 }
 
+/*
+ * Marks the given container and all of its ancestors as changed, so that the
+ * next tree_render() will not skip the workspace it is on.
+ *
+ */
+void con_mark_dirty(Con *con) {
+    for (Con *current = con; current != NULL; current = current->parent) {
+        current->dirty = true;
+    }
+}
+
+/*
+ * Returns true if the given container is a workspace which is not the visible
+ * workspace of its output and in which nothing changed since the last
+ * tree_render(). Such a workspace has already been unmapped and pushed to X11
+ * completely, so the render passes can skip its subtree.
+ *
+ */
+bool con_is_clean_hidden_workspace(Con *con) {
+    return con->type == CT_WORKSPACE &&
+           !con->dirty &&
+           con->parent != NULL &&
+           TAILQ_FIRST(&(con->parent->focus_head)) != con;
+}
+
 /*
  * Create a new container (and attach it to the given parent, if not NULL).
  * This function only initializes the data structures.
  *
  */
 Con *con_new_skeleton(Con *parent, i3Window *window) {
-    Con *new = scalloc(1, sizeof(Con));
+    Con *new = create_struct<Con>();
+    new->cold = create_struct<con_cold>();
+    con_assign_id(new);
     new->on_remove_child = con_on_remove_child;
     TAILQ_INSERT_TAIL(&all_cons, new, all_cons);
     new->type = CT_CON;
     new->window = window;
     new->border_style = config.default_border;
     new->current_border_width = -1;
-    new->window_icon_padding = -1;
+    new->cold->window_icon_padding = -1;
     if (window) {
         new->depth = window->depth;
     } else {
@@ -54,8 +153,11 @@ Con *con_new_skeleton(Con *parent, i3Window *window) {
     TAILQ_INIT(&(new->floating_head));
     TAILQ_INIT(&(new->nodes_head));
     TAILQ_INIT(&(new->focus_head));
-    TAILQ_INIT(&(new->swallow_head));
-    TAILQ_INIT(&(new->marks_head));
+    TAILQ_INIT(&(new->cold->swallow_head));
+    TAILQ_INIT(&(new->cold->marks_head));
+
+    if (window != NULL)
+        con_index_window(new);
 
     if (parent != NULL)
         con_attach(new, parent, false);
@@ -72,28 +174,56 @@ Con *con_new(Con *parent, i3Window *window) {
     return new;
 }
 
+/*
+ * Frees a mark which has already been removed from its container.
+ *
+ */
+static void mark_free(mark_t *mark) {
+    str_table_remove(&cons_by_mark, mark->name);
+    FREE(mark->name);
+    destroy_struct(mark);
+}
+
 /*
  * Frees the specified container.
  *
  */
 void con_free(Con *con) {
+    tree_delta_freed(con);
+    if (con->type == CT_WORKSPACE)
+        workspace_invalidate_index();
     free(con->name);
-    FREE(con->deco_render_params);
+    con_unindex_window(con);
+    con_unindex_frame(con);
+    con_release_id(con);
     TAILQ_REMOVE(&all_cons, con, all_cons);
-    while (!TAILQ_EMPTY(&(con->swallow_head))) {
-        Match *match = TAILQ_FIRST(&(con->swallow_head));
-        TAILQ_REMOVE(&(con->swallow_head), match, matches);
+    while (!TAILQ_EMPTY(&(con->cold->swallow_head))) {
+        Match *match = TAILQ_FIRST(&(con->cold->swallow_head));
+        TAILQ_REMOVE(&(con->cold->swallow_head), match, matches);
         match_free(match);
-        free(match);
+        destroy_struct(match);
     }
-    while (!TAILQ_EMPTY(&(con->marks_head))) {
-        mark_t *mark = TAILQ_FIRST(&(con->marks_head));
-        TAILQ_REMOVE(&(con->marks_head), mark, marks);
-        FREE(mark->name);
-        FREE(mark);
+    while (!TAILQ_EMPTY(&(con->cold->marks_head))) {
+        mark_t *mark = TAILQ_FIRST(&(con->cold->marks_head));
+        TAILQ_REMOVE(&(con->cold->marks_head), mark, marks);
+        mark_free(mark);
     }
+    con_invalidate_formatted_marks(con);
+    FREE(con->cold->tree_representation);
     DLOG("con %p freed\n", con);
-    free(con);
+    destroy_struct(con->cold);
+    destroy_struct(con);
+}
+
+/*
+ * Returns true if attaching the given container to (or detaching it from) the
+ * given parent changes which workspaces exist or their order.
+ *
+ */
+static bool con_affects_workspace_index(Con *con, Con *parent) {
+    return (con->type == CT_WORKSPACE ||
+            con->type == CT_OUTPUT ||
+            parent->type == CT_OUTPUT);
 }
 
 static void _con_attach(Con *con, Con *parent, Con *previous, bool ignore_focus) {
@@ -207,6 +337,10 @@ add_to_focus_head:
      * to focus them. */
     TAILQ_INSERT_TAIL(focus_head, con, focused);
     con_force_split_parents_redraw(con);
+    con_mark_dirty(con);
+    tree_delta_attached(con);
+    if (con_affects_workspace_index(con, con->parent))
+        workspace_invalidate_index();
 }
 
 /*
@@ -229,6 +363,10 @@ void con_attach(Con *con, Con *parent, bool ignore_focus) {
  */
 void con_detach(Con *con) {
     con_force_split_parents_redraw(con);
+    con_mark_dirty(con);
+    tree_delta_children(con->parent);
+    if (con_affects_workspace_index(con, con->parent))
+        workspace_invalidate_index();
     if (con->type == CT_FLOATING_CON) {
         TAILQ_REMOVE(&(con->parent->floating_head), con, floating_windows);
         TAILQ_REMOVE(&(con->parent->focus_head), con, focused);
@@ -247,6 +385,22 @@ void con_focus(Con *con) {
     assert(con != NULL);
     DLOG("con_focus = %p\n", con);
 
+    /* The previously focused sibling might become hidden (for example a
+     * workspace or a tab), so it needs to be pushed to X11 as well. */
+    Con *previous = TAILQ_FIRST(&(con->parent->focus_head));
+    if (previous != NULL && previous != con) {
+        con_mark_dirty(previous);
+    }
+    con_mark_dirty(con);
+
+    /* The focused flag moves from the previously focused container to this
+     * one and the focus stack of the parent changes. */
+    if (focused != con) {
+        tree_delta_property(focused, TREE_DELTA_FOCUS);
+        tree_delta_property(con, TREE_DELTA_FOCUS);
+    }
+    tree_delta_property(con->parent, TREE_DELTA_FOCUS);
+
     /* 1: set focused-pointer to the new con */
     /* 2: exchange the position of the container in focus stack of the parent all the way up */
     TAILQ_REMOVE(&(con->parent->focus_head), con, focused);
@@ -666,38 +820,62 @@ bool con_has_parent(Con *con, Con *parent) {
  *
  */
 Con *con_by_window_id(xcb_window_t window) {
-    Con *con;
-    TAILQ_FOREACH (con, &all_cons, all_cons) {
-        if (con->window != NULL && con->window->id == window) {
-            return con;
-        }
+    Con *con = id_table_lookup(&cons_by_window, window);
+    if (con == NULL || con->window == NULL || con->window->id != window) {
+        return NULL;
     }
-    return NULL;
+    return con;
 }
 
 /*
- * Returns the container with the given container ID or NULL if no such
- * container exists.
+ * Adds the client window of the given container to the index used by
+ * con_by_window_id(). Has to be called whenever con->window is assigned.
  *
  */
-Con *con_by_con_id(long target) {
-    Con *con;
-    TAILQ_FOREACH (con, &all_cons, all_cons) {
-        if (con == (Con *)target) {
-            return con;
-        }
+void con_index_window(Con *con) {
+    if (con->window == NULL) {
+        return;
     }
+    id_table_insert(&cons_by_window, con->window->id, con);
+}
 
-    return NULL;
+/*
+ * Removes the client window of the given container from the index used by
+ * con_by_window_id(). Has to be called before con->window is freed or handed
+ * over to another container.
+ *
+ */
+void con_unindex_window(Con *con) {
+    if (con->window == NULL) {
+        return;
+    }
+    if (id_table_lookup(&cons_by_window, con->window->id) == con) {
+        id_table_remove(&cons_by_window, con->window->id);
+    }
 }
 
 /*
- * Returns true if the given container (still) exists.
- * This can be used, e.g., to make sure a container hasn't been closed in the meantime.
+ * Returns the container with the given container ID (see Con.id) or NULL if no
+ * such container exists (anymore).
+ *
+ * Since IDs are never reused, this can also be used to make sure a container
+ * hasn't been closed in the meantime.
  *
  */
-bool con_exists(Con *con) {
-    return con_by_con_id((long)con) != NULL;
+Con *con_by_con_id(long target) {
+    if (target <= 0)
+        return NULL;
+
+    uint64_t id = target;
+    uint64_t index = (id & ((1U << CON_ID_INDEX_BITS) - 1));
+    if (index == 0 || index > con_slots_count)
+        return NULL;
+
+    struct con_slot *slot = &con_slots[index - 1];
+    if (slot->con == NULL || slot->con->id != id)
+        return NULL;
+
+    return slot->con;
 }
 
 /*
@@ -706,13 +884,37 @@ bool con_exists(Con *con) {
  *
  */
 Con *con_by_frame_id(xcb_window_t frame) {
-    Con *con;
-    TAILQ_FOREACH (con, &all_cons, all_cons) {
-        if (con->frame.id == frame) {
-            return con;
-        }
+    Con *con = id_table_lookup(&cons_by_frame, frame);
+    if (con == NULL || con->frame.id != frame) {
+        return NULL;
+    }
+    return con;
+}
+
+/*
+ * Adds the frame of the given container to the index used by
+ * con_by_frame_id(). Called from x_con_init() once the frame exists.
+ *
+ */
+void con_index_frame(Con *con) {
+    if (con->frame.id == XCB_NONE) {
+        return;
+    }
+    id_table_insert(&cons_by_frame, con->frame.id, con);
+}
+
+/*
+ * Removes the frame of the given container from the index used by
+ * con_by_frame_id().
+ *
+ */
+void con_unindex_frame(Con *con) {
+    if (con->frame.id == XCB_NONE) {
+        return;
+    }
+    if (id_table_lookup(&cons_by_frame, con->frame.id) == con) {
+        id_table_remove(&cons_by_frame, con->frame.id);
     }
-    return NULL;
 }
 
 /*
@@ -721,13 +923,7 @@ Con *con_by_frame_id(xcb_window_t frame) {
  *
  */
 Con *con_by_mark(const char *mark) {
-    Con *con;
-    TAILQ_FOREACH (con, &all_cons, all_cons) {
-        if (con_has_mark(con, mark))
-            return con;
-    }
-
-    return NULL;
+    return str_table_lookup(&cons_by_mark, mark);
 }
 
 /*
@@ -736,7 +932,7 @@ Con *con_by_mark(const char *mark) {
  */
 bool con_has_mark(Con *con, const char *mark) {
     mark_t *current;
-    TAILQ_FOREACH (current, &(con->marks_head), marks) {
+    TAILQ_FOREACH (current, &(con->cold->marks_head), marks) {
         if (strcmp(current->name, mark) == 0)
             return true;
     }
@@ -774,18 +970,43 @@ void con_mark(Con *con, const char *mark, mark_mode_t mode) {
         DLOG("Removing all existing marks on con = %p.\n", con);
 
         mark_t *current;
-        while (!TAILQ_EMPTY(&(con->marks_head))) {
-            current = TAILQ_FIRST(&(con->marks_head));
+        while (!TAILQ_EMPTY(&(con->cold->marks_head))) {
+            current = TAILQ_FIRST(&(con->cold->marks_head));
             con_unmark(con, current->name);
         }
     }
 
-    mark_t *new = scalloc(1, sizeof(mark_t));
+    mark_t *new = create_struct<mark_t>();
     new->name = sstrdup(mark);
-    TAILQ_INSERT_TAIL(&(con->marks_head), new, marks);
+    TAILQ_INSERT_TAIL(&(con->cold->marks_head), new, marks);
+    str_table_insert(&cons_by_mark, new->name, con);
     ipc_send_window_event("mark", con);
 
-    con->mark_changed = true;
+    con->cold->mark_changed = true;
+    con_invalidate_formatted_marks(con);
+    tree_delta_property(con, TREE_DELTA_MARKS);
+}
+
+/*
+ * Removes all marks from the given container.
+ *
+ */
+static void con_unmark_all(Con *con) {
+    if (TAILQ_EMPTY(&(con->cold->marks_head)))
+        return;
+
+    mark_t *mark;
+    while (!TAILQ_EMPTY(&(con->cold->marks_head))) {
+        mark = TAILQ_FIRST(&(con->cold->marks_head));
+        TAILQ_REMOVE(&(con->cold->marks_head), mark, marks);
+        mark_free(mark);
+
+        ipc_send_window_event("mark", con);
+    }
+
+    con->cold->mark_changed = true;
+    con_invalidate_formatted_marks(con);
+    tree_delta_property(con, TREE_DELTA_MARKS);
 }
 
 /*
@@ -798,25 +1019,15 @@ void con_mark(Con *con, const char *mark, mark_mode_t mode) {
 void con_unmark(Con *con, const char *name) {
     Con *current;
     if (name == NULL) {
+        if (con != NULL) {
+            DLOG("Unmarking con = %p.\n", con);
+            con_unmark_all(con);
+            return;
+        }
+
         DLOG("Unmarking all containers.\n");
         TAILQ_FOREACH (current, &all_cons, all_cons) {
-            if (con != NULL && current != con)
-                continue;
-
-            if (TAILQ_EMPTY(&(current->marks_head)))
-                continue;
-
-            mark_t *mark;
-            while (!TAILQ_EMPTY(&(current->marks_head))) {
-                mark = TAILQ_FIRST(&(current->marks_head));
-                FREE(mark->name);
-                TAILQ_REMOVE(&(current->marks_head), mark, marks);
-                FREE(mark);
-
-                ipc_send_window_event("mark", current);
-            }
-
-            current->mark_changed = true;
+            con_unmark_all(current);
         }
     } else {
         DLOG("Removing mark \"%s\".\n", name);
@@ -827,16 +1038,17 @@ void con_unmark(Con *con, const char *name) {
         }
 
         DLOG("Found mark on con = %p. Removing it now.\n", current);
-        current->mark_changed = true;
+        current->cold->mark_changed = true;
+        con_invalidate_formatted_marks(current);
+        tree_delta_property(current, TREE_DELTA_MARKS);
 
         mark_t *mark;
-        TAILQ_FOREACH (mark, &(current->marks_head), marks) {
+        TAILQ_FOREACH (mark, &(current->cold->marks_head), marks) {
             if (strcmp(mark->name, name) != 0)
                 continue;
 
-            FREE(mark->name);
-            TAILQ_REMOVE(&(current->marks_head), mark, marks);
-            FREE(mark);
+            TAILQ_REMOVE(&(current->cold->marks_head), mark, marks);
+            mark_free(mark);
 
             ipc_send_window_event("mark", current);
             break;
@@ -844,6 +1056,58 @@ void con_unmark(Con *con, const char *name) {
     }
 }
 
+/*
+ * Returns the visible marks of the container (those not starting with an
+ * underscore) formatted for its window decoration as "[mark1][mark2]", or NULL
+ * if there are none. The predicted width of the string is stored in width.
+ *
+ * The result is cached on the container until its marks or the font change.
+ *
+ */
+i3String *con_get_formatted_marks(Con *con, int *width) {
+    if (!con->cold->formatted_marks_valid) {
+        size_t len = 0;
+        mark_t *mark;
+        TAILQ_FOREACH (mark, &(con->cold->marks_head), marks) {
+            if (mark->name[0] != '_')
+                len += strlen(mark->name) + 2;
+        }
+
+        if (len > 0) {
+            char *buf = smalloc(len + 1);
+            char *walk = buf;
+            TAILQ_FOREACH (mark, &(con->cold->marks_head), marks) {
+                if (mark->name[0] == '_')
+                    continue;
+                size_t mark_len = strlen(mark->name);
+                *walk++ = '[';
+                memcpy(walk, mark->name, mark_len);
+                walk += mark_len;
+                *walk++ = ']';
+            }
+            *walk = '\0';
+
+            con->cold->formatted_marks = i3string_from_utf8(buf);
+            con->cold->formatted_marks_width = predict_text_width(con->cold->formatted_marks);
+            free(buf);
+        }
+        con->cold->formatted_marks_valid = true;
+    }
+
+    *width = con->cold->formatted_marks_width;
+    return con->cold->formatted_marks;
+}
+
+/*
+ * Drops the cached result of con_get_formatted_marks().
+ *
+ */
+void con_invalidate_formatted_marks(Con *con) {
+    I3STRING_FREE(con->cold->formatted_marks);
+    con->cold->formatted_marks_width = 0;
+    con->cold->formatted_marks_valid = false;
+}
+
 /*
  * Returns the first container below 'con' which wants to swallow this window
  * TODO: priority
@@ -856,7 +1120,7 @@ Con *con_for_window(Con *con, i3Window *window, Match **store_match) {
     //DLOG("class == %s\n", window->class_class);
 
     TAILQ_FOREACH (child, &(con->nodes_head), nodes) {
-        TAILQ_FOREACH (match, &(child->swallow_head), matches) {
+        TAILQ_FOREACH (match, &(child->cold->swallow_head), matches) {
             if (!match_matches_window(match, window))
                 continue;
             if (store_match != NULL)
@@ -869,7 +1133,7 @@ Con *con_for_window(Con *con, i3Window *window, Match **store_match) {
     }
 
     TAILQ_FOREACH (child, &(con->floating_head), floating_windows) {
-        TAILQ_FOREACH (match, &(child->swallow_head), matches) {
+        TAILQ_FOREACH (match, &(child->cold->swallow_head), matches) {
             if (!match_matches_window(match, window))
                 continue;
             if (store_match != NULL)
@@ -921,6 +1185,8 @@ Con **get_focus_order(Con *con) {
  *
  */
 void set_focus_order(Con *con, Con **focus_order) {
+    con_mark_dirty(con);
+
     int focus_heads = 0;
     while (!TAILQ_EMPTY(&(con->focus_head))) {
         Con *current = TAILQ_FIRST(&(con->focus_head));
@@ -1078,6 +1344,8 @@ void con_toggle_fullscreen(Con *con, int fullscreen_mode) {
  */
 static void con_set_fullscreen_mode(Con *con, fullscreen_mode_t fullscreen_mode) {
     con->fullscreen_mode = fullscreen_mode;
+    con_mark_dirty(con);
+    tree_delta_property(con, TREE_DELTA_FULLSCREEN);
 
     DLOG("mode now: %d\n", con->fullscreen_mode);
 
@@ -1347,7 +1615,7 @@ static bool _con_move_to_con(Con *con, Con *target, bool behind_focused, bool fi
     }
 
     /* Ensure the container will be redrawn. */
-    FREE(con->deco_render_params);
+    con->deco_render_params_valid = false;
 
     CALL(parent, on_remove_child);
 
@@ -1758,6 +2026,8 @@ int con_border_style(Con *con) {
  *
  */
 void con_set_border_style(Con *con, int border_style, int border_width) {
+    tree_delta_property(con, TREE_DELTA_BORDER);
+
     /* Handle the simple case: non-floating containerns */
     if (!con_is_floating(con)) {
         con->border_style = border_style;
@@ -1782,6 +2052,7 @@ void con_set_border_style(Con *con, int border_style, int border_width) {
     parent->rect.height -= deco_height;
 
     /* Change the border style, get new border/decoration values. */
+    con_mark_dirty(con);
     con->border_style = border_style;
     con->current_border_width = border_width;
     bsr = con_border_style_rect(con);
@@ -1803,6 +2074,9 @@ void con_set_layout(Con *con, layout_t layout) {
     DLOG("con_set_layout(%p, %d), con->type = %d\n",
          con, layout, con->type);
 
+    con_mark_dirty(con);
+    tree_delta_property(con, TREE_DELTA_LAYOUT);
+
     /* Users can focus workspaces, but not any higher in the hierarchy.
      * Focus on the workspace is a special case, since in every other case, the
      * user means "change the layout of the parent split container". */
@@ -1994,21 +2268,26 @@ static void con_on_remove_child(Con *con) {
     if (con->type == CT_WORKSPACE) {
         if (TAILQ_EMPTY(&(con->focus_head)) && !workspace_is_visible(con)) {
             LOG("Closing old workspace (%p / %s), it is empty\n", con, con->name);
-            yajl_gen gen = ipc_marshal_workspace_event("empty", con, NULL);
+            yajl_gen gen = NULL;
+            if (ipc_has_subscribers(I3_IPC_EVENT_WORKSPACE))
+                gen = ipc_marshal_workspace_event("empty", con, NULL);
             tree_close_internal(con, DONT_KILL_WINDOW, false);
 
-            const unsigned char *payload;
-            ylength length;
-            y(get_buf, &payload, &length);
-            ipc_send_event("workspace", I3_IPC_EVENT_WORKSPACE, (const char *)payload);
+            if (gen != NULL) {
+                const unsigned char *payload;
+                ylength length;
+                y(get_buf, &payload, &length);
+                ipc_send_event(I3_IPC_EVENT_WORKSPACE, (const char *)payload);
 
-            y(free);
+                y(free);
+            }
         }
         return;
     }
 
     con_force_split_parents_redraw(con);
     con->urgent = con_has_urgent_child(con);
+    tree_delta_property(con, TREE_DELTA_URGENT);
     con_update_parents_urgency(con);
 
     /* TODO: check if this container would swallow any other client and
@@ -2181,6 +2460,7 @@ void con_update_parents_urgency(Con *con) {
             if (!con_has_urgent_child(parent))
                 parent->urgent = false;
         }
+        tree_delta_property(parent, TREE_DELTA_URGENT);
         parent = parent->parent;
     }
 }
@@ -2197,8 +2477,9 @@ void con_set_urgency(Con *con, bool urgent) {
 
     const bool old_urgent = con->urgent;
 
-    if (con->urgency_timer == NULL) {
+    if (con->cold->urgency_timer == NULL) {
         con->urgent = urgent;
+        tree_delta_property(con, TREE_DELTA_URGENT);
     } else
         DLOG("Discarding urgency WM_HINT because timer is running\n");
 
@@ -2227,10 +2508,19 @@ void con_set_urgency(Con *con, bool urgent) {
 }
 
 /*
- * Create a string representing the subtree under con.
+ * Returns the tree representation of the container (see
+ * con_get_tree_representation()), building it from the (cached)
+ * representations of the children if it is not cached yet. The string is
+ * owned by the container.
+ *
+ * If a container's representation is cached, so are those of all its
+ * descendants, which con_invalidate_tree_representation() relies on.
  *
  */
-char *con_get_tree_representation(Con *con) {
+static const char *con_tree_representation(Con *con) {
+    if (con->cold->tree_representation != NULL)
+        return con->cold->tree_representation;
+
     /* this code works as follows:
      *  1) create a string with the layout type (D/V/H/T/S) and an opening bracket
      *  2) append the tree representation of the children to the string
@@ -2243,50 +2533,84 @@ char *con_get_tree_representation(Con *con) {
     /* end of recursion */
     if (con_is_leaf(con)) {
         if (!con->window)
-            return sstrdup("nowin");
-
-        if (!con->window->class_instance)
-            return sstrdup("noinstance");
-
-        return sstrdup(con->window->class_instance);
+            con->cold->tree_representation = sstrdup("nowin");
+        else if (!con->window->class_instance)
+            con->cold->tree_representation = sstrdup("noinstance");
+        else
+            con->cold->tree_representation = sstrdup(con->window->class_instance);
+        return con->cold->tree_representation;
     }
 
-    char *buf;
-    /* 1) add the Layout type to buf */
+    /* 1) the Layout type */
+    char layout;
     if (con->layout == L_DEFAULT)
-        buf = sstrdup("D[");
+        layout = 'D';
     else if (con->layout == L_SPLITV)
-        buf = sstrdup("V[");
+        layout = 'V';
     else if (con->layout == L_SPLITH)
-        buf = sstrdup("H[");
+        layout = 'H';
     else if (con->layout == L_TABBED)
-        buf = sstrdup("T[");
+        layout = 'T';
     else if (con->layout == L_STACKED)
-        buf = sstrdup("S[");
+        layout = 'S';
     else {
         ELOG("BUG: Code not updated to account for new layout type\n");
         assert(false);
     }
 
-    /* 2) append representation of children */
+    /* 2) the representation of the children, which we measure first so that
+     * the whole string can be allocated at once. */
+    size_t len = strlen("X[]");
     Con *child;
     TAILQ_FOREACH (child, &(con->nodes_head), nodes) {
-        char *child_txt = con_get_tree_representation(child);
+        len += strlen(con_tree_representation(child)) +
+               (TAILQ_FIRST(&(con->nodes_head)) == child ? 0 : 1);
+    }
 
-        char *tmp_buf;
-        sasprintf(&tmp_buf, "%s%s%s", buf,
-                  (TAILQ_FIRST(&(con->nodes_head)) == child ? "" : " "), child_txt);
-        free(buf);
-        buf = tmp_buf;
-        free(child_txt);
+    char *buf = smalloc(len + 1);
+    char *pos = buf;
+    *(pos++) = layout;
+    *(pos++) = '[';
+    TAILQ_FOREACH (child, &(con->nodes_head), nodes) {
+        if (TAILQ_FIRST(&(con->nodes_head)) != child)
+            *(pos++) = ' ';
+        const char *child_txt = child->cold->tree_representation;
+        size_t child_len = strlen(child_txt);
+        memcpy(pos, child_txt, child_len);
+        pos += child_len;
     }
 
     /* 3) close the brackets */
-    char *complete_buf;
-    sasprintf(&complete_buf, "%s]", buf);
-    free(buf);
+    *(pos++) = ']';
+    *pos = '\0';
 
-    return complete_buf;
+    con->cold->tree_representation = buf;
+    return buf;
+}
+
+/*
+ * Create a string representing the subtree under con.
+ *
+ */
+char *con_get_tree_representation(Con *con) {
+    return sstrdup(con_tree_representation(con));
+}
+
+/*
+ * Drops the cached tree representation of the container and of all its
+ * ancestors. Has to be called whenever the layout, the children or the window
+ * class of the container change.
+ *
+ */
+void con_invalidate_tree_representation(Con *con) {
+    FREE(con->cold->tree_representation);
+
+    /* An uncached parent implies that its ancestors are uncached as well. */
+    for (Con *parent = con->parent;
+         parent != NULL && parent->cold->tree_representation != NULL;
+         parent = parent->parent) {
+        FREE(parent->cold->tree_representation);
+    }
 }
 
 /*
@@ -2294,7 +2618,7 @@ char *con_get_tree_representation(Con *con) {
  *
  */
 i3String *con_parse_title_format(Con *con) {
-    assert(con->title_format != NULL);
+    assert(con->cold->title_format != NULL);
 
     i3Window *win = con->window;
 
@@ -2326,7 +2650,7 @@ i3String *con_parse_title_format(Con *con) {
     };
     const size_t num = sizeof(placeholders) / sizeof(placeholder_t);
 
-    char *formatted_str = format_placeholders(con->title_format, &placeholders[0], num);
+    char *formatted_str = format_placeholders(con->cold->title_format, &placeholders[0], num);
     i3String *formatted = i3string_from_utf8(formatted_str);
     i3string_set_markup(formatted, pango_markup);
 
@@ -2408,6 +2732,8 @@ bool con_swap(Con *first, Con *second) {
     SWAP_CONS_IN_TREE(nodes_head, nodes);
     SWAP_CONS_IN_TREE(focus_head, focused);
     SWAP(first->parent, second->parent, Con *);
+    tree_delta_children(first->parent);
+    tree_delta_children(second->parent);
 
     /* Floating nodes are children of CT_FLOATING_CONs, they are listed in
      * nodes_head and focus_head like all other containers. Thus, we don't need
@@ -2449,8 +2775,8 @@ bool con_swap(Con *first, Con *second) {
     con_fix_percent(first->parent);
     con_fix_percent(second->parent);
 
-    FREE(first->deco_render_params);
-    FREE(second->deco_render_params);
+    first->deco_render_params_valid = false;
+    second->deco_render_params_valid = false;
     con_force_split_parents_redraw(first);
     con_force_split_parents_redraw(second);
 
@@ -2473,32 +2799,39 @@ uint32_t con_rect_size_in_orientation(Con *con) {
  *
  */
 void con_merge_into(Con *old, Con *new) {
+    con_unindex_window(old);
     new->window = old->window;
     old->window = NULL;
+    con_index_window(new);
+    con_invalidate_tree_representation(old);
+    con_invalidate_tree_representation(new);
 
-    if (old->title_format) {
-        FREE(new->title_format);
-        new->title_format = old->title_format;
-        old->title_format = NULL;
+    if (old->cold->title_format) {
+        FREE(new->cold->title_format);
+        new->cold->title_format = old->cold->title_format;
+        old->cold->title_format = NULL;
     }
 
-    if (old->sticky_group) {
-        FREE(new->sticky_group);
-        new->sticky_group = old->sticky_group;
-        old->sticky_group = NULL;
+    if (old->cold->sticky_group) {
+        FREE(new->cold->sticky_group);
+        new->cold->sticky_group = old->cold->sticky_group;
+        old->cold->sticky_group = NULL;
     }
 
     new->sticky = old->sticky;
 
     con_set_urgency(new, old->urgent);
 
-    mark_t *mark;
-    TAILQ_FOREACH (mark, &(old->marks_head), marks) {
-        TAILQ_INSERT_TAIL(&(new->marks_head), mark, marks);
+    new->cold->mark_changed = (TAILQ_FIRST(&(old->cold->marks_head)) != NULL);
+    while (!TAILQ_EMPTY(&(old->cold->marks_head))) {
+        mark_t *mark = TAILQ_FIRST(&(old->cold->marks_head));
+        TAILQ_REMOVE(&(old->cold->marks_head), mark, marks);
+        TAILQ_INSERT_TAIL(&(new->cold->marks_head), mark, marks);
+        str_table_insert(&cons_by_mark, mark->name, new);
         ipc_send_window_event("mark", new);
     }
-    new->mark_changed = (TAILQ_FIRST(&(old->marks_head)) != NULL);
-    TAILQ_INIT(&(old->marks_head));
+    con_invalidate_formatted_marks(new);
+    con_invalidate_formatted_marks(old);
 
     tree_close_internal(old, DONT_KILL_WINDOW, false);
 }
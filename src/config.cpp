@@ -141,7 +141,8 @@ static void free_configuration(void) {
             FREE(con->window->ran_assignments);
         }
         /* Invalidate pixmap caches in case font or colors changed. */
-        FREE(con->deco_render_params);
+        con->deco_render_params_valid = false;
+        con_invalidate_formatted_marks(con);
     }
 
     /* Get rid of the current font */
@@ -183,6 +184,10 @@ bool load_configuration(const char *override_configpath, config_load_t load_type
     /* Clear the old config or initialize the data structure */
     memset(&config, 0, sizeof(config));
 
+    /* Reset the settings which are stored outside of the config struct, so
+     * that removing their directives takes effect on reload. */
+    ipc_set_high_water_mark(0);
+
     /* Initialize default colors */
 #define INIT_COLOR(x, cborder, cbackground, ctext, cindicator) \
     do {                                                       \
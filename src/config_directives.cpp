@@ -552,6 +552,10 @@ CFGFUN(ipc_kill_timeout, const long timeout_ms) {
     ipc_set_kill_timeout(timeout_ms / 1000.0);
 }
 
+CFGFUN(ipc_high_water_mark, const long bytes) {
+    ipc_set_high_water_mark(bytes > 0 ? (size_t)bytes : 0);
+}
+
 /*******************************************************************************
  * Bar configuration (i3bar)
  ******************************************************************************/
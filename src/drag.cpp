@@ -19,6 +19,8 @@ struct drag_x11_cb {
     /* The container that is being dragged or resized, or NULL if this is a
      * drag of the resize handle. */
     Con *con;
+    /* The ID of con, to notice when it is closed during the drag. */
+    uint64_t con_id;
 
     /* The original event that initiated the drag. */
     const xcb_button_press_event_t *event;
@@ -117,6 +119,10 @@ static bool drain_drag_events(EV_P, struct drag_x11_cb *dragloop) {
         }
     }
 
+    /* The modal drag loop replaces xcb_prepare_cb(), so we need to do the
+     * renders requested by the handlers ourselves. */
+    tree_flush_render();
+
     if (last_motion_notify == NULL) {
         return true;
     }
@@ -137,7 +143,7 @@ static bool drain_drag_events(EV_P, struct drag_x11_cb *dragloop) {
     /* Ensure that we are either dragging the resize handle (con is NULL) or that the
      * container still exists. The latter might not be true, e.g., if the window closed
      * for any reason while the user was dragging it. */
-    if (dragloop->threshold_exceeded && (!dragloop->con || con_exists(dragloop->con))) {
+    if (dragloop->threshold_exceeded && (!dragloop->con || con_by_con_id(dragloop->con_id) != NULL)) {
         dragloop->callback(
             dragloop->con,
             &(dragloop->old_rect),
@@ -225,6 +231,7 @@ drag_result_t drag_pointer(Con *con, const xcb_button_press_event_t *event,
     struct drag_x11_cb loop = {
         .result = DRAGGING,
         .con = con,
+        .con_id = (con ? con->id : 0),
         .event = event,
         .callback = callback,
         .threshold_exceeded = !use_threshold,
@@ -287,6 +287,7 @@ bool floating_enable(Con *con, bool automatic) {
      * is necessary because otherwise the workspace might be empty (and get
      * closed in tree_close_internal()) even though it’s not. */
     TAILQ_INSERT_HEAD(&(ws->floating_head), nc, floating_windows);
+    tree_delta_attached(nc);
 
     struct focus_head *fh = &(ws->focus_head);
     if (focus_before_parent) {
@@ -323,17 +324,17 @@ bool floating_enable(Con *con, bool automatic) {
     int deco_height = render_deco_height();
 
     DLOG("Original rect: (%d, %d) with %d x %d\n", con->rect.x, con->rect.y, con->rect.width, con->rect.height);
-    DLOG("Geometry = (%d, %d) with %d x %d\n", con->geometry.x, con->geometry.y, con->geometry.width, con->geometry.height);
-    nc->rect = con->geometry;
+    DLOG("Geometry = (%d, %d) with %d x %d\n", con->cold->geometry.x, con->cold->geometry.y, con->cold->geometry.width, con->cold->geometry.height);
+    nc->rect = con->cold->geometry;
     /* If the geometry was not set (split containers), we need to determine a
      * sensible one by combining the geometry of all children */
     if (rect_equals(nc->rect, (Rect){0, 0, 0, 0})) {
         DLOG("Geometry not set, combining children\n");
         Con *child;
         TAILQ_FOREACH (child, &(con->nodes_head), nodes) {
-            DLOG("child geometry: %d x %d\n", child->geometry.width, child->geometry.height);
-            nc->rect.width += child->geometry.width;
-            nc->rect.height = max(nc->rect.height, child->geometry.height);
+            DLOG("child geometry: %d x %d\n", child->cold->geometry.width, child->cold->geometry.height);
+            nc->rect.width += child->cold->geometry.width;
+            nc->rect.height = max(nc->rect.height, child->cold->geometry.height);
         }
     }
 
@@ -345,6 +346,8 @@ bool floating_enable(Con *con, bool automatic) {
     con->parent = nc;
     con->percent = 1.0;
     con->floating = FLOATING_USER_ON;
+    tree_delta_attached(con);
+    tree_delta_property(con, TREE_DELTA_FLOATING);
 
     /* 4: set the border style as specified with new_float */
     if (automatic)
@@ -450,6 +453,8 @@ void floating_disable(Con *con) {
     }
 
     con->floating = FLOATING_USER_OFF;
+    con_mark_dirty(con);
+    tree_delta_property(con, TREE_DELTA_FLOATING);
     floating_set_hint_atom(con, false);
     ipc_send_window_event("floating", con);
 }
@@ -487,6 +492,8 @@ void floating_raise_con(Con *con) {
     DLOG("Raising floating con %p / %s\n", con, con->name);
     TAILQ_REMOVE(&(con->parent->floating_head), con, floating_windows);
     TAILQ_INSERT_TAIL(&(con->parent->floating_head), con, floating_windows);
+    con_mark_dirty(con);
+    tree_delta_children(con->parent);
 }
 
 /*
@@ -607,9 +614,10 @@ void floating_drag_window(Con *con, const xcb_button_press_event_t *event, bool
     Rect initial_rect = con->rect;
 
     /* Drag the window */
+    const uint64_t con_id = con->id;
     drag_result_t drag_result = drag_pointer(con, event, XCB_NONE, XCURSOR_CURSOR_MOVE, use_threshold, drag_window_callback, NULL);
 
-    if (!con_exists(con)) {
+    if (con_by_con_id(con_id) == NULL) {
         DLOG("The container has been closed in the meantime.\n");
         return;
     }
@@ -721,9 +729,10 @@ void floating_resize_window(Con *con, const bool proportional,
     /* get the initial rect in case of revert/cancel */
     Rect initial_rect = con->rect;
 
+    const uint64_t con_id = con->id;
     drag_result_t drag_result = drag_pointer(con, event, XCB_NONE, cursor, false, resize_window_callback, &params);
 
-    if (!con_exists(con)) {
+    if (con_by_con_id(con_id) == NULL) {
         DLOG("The container has been closed in the meantime.\n");
         return;
     }
@@ -114,7 +114,7 @@ static void check_crossing_screen_boundary(uint32_t x, uint32_t y) {
 
     /* If the focus changed, we re-render to get updated decorations */
     if (old_focused != focused)
-        tree_render();
+        tree_request_render();
 }
 
 /*
@@ -185,7 +185,7 @@ static void handle_enter_notify(xcb_enter_notify_event_t *event) {
 
     focused_id = XCB_NONE;
     con_focus(con_descend_focused(con));
-    tree_render();
+    tree_request_render();
 }
 
 /*
@@ -364,13 +364,13 @@ static void handle_configure_request(xcb_configure_request_event_t *event) {
         if (event->value_mask & XCB_CONFIG_WINDOW_HEIGHT) {
             DLOG("Dock client wants to change height to %d, we can do that.\n", event->height);
 
-            con->geometry.height = event->height;
-            tree_render();
+            con->cold->geometry.height = event->height;
+            tree_request_render();
         }
 
         if (event->value_mask & XCB_CONFIG_WINDOW_X || event->value_mask & XCB_CONFIG_WINDOW_Y) {
-            int16_t x = event->value_mask & XCB_CONFIG_WINDOW_X ? event->x : (int16_t)con->geometry.x;
-            int16_t y = event->value_mask & XCB_CONFIG_WINDOW_Y ? event->y : (int16_t)con->geometry.y;
+            int16_t x = event->value_mask & XCB_CONFIG_WINDOW_X ? event->x : (int16_t)con->cold->geometry.x;
+            int16_t y = event->value_mask & XCB_CONFIG_WINDOW_Y ? event->y : (int16_t)con->cold->geometry.y;
 
             Con *current_output = con_get_output(con);
             Output *target = get_output_containing(x, y);
@@ -382,7 +382,7 @@ static void handle_configure_request(xcb_configure_request_event_t *event) {
                 con_detach(con);
                 con_attach(con, nc, false);
 
-                tree_render();
+                tree_request_render();
             } else {
                 DLOG("Dock client will not be moved, we only support moving it to another output.\n");
             }
@@ -414,11 +414,11 @@ static void handle_configure_request(xcb_configure_request_event_t *event) {
             DLOG("Focusing con = %p\n", con);
             workspace_show(workspace);
             con_activate_unblock(con);
-            tree_render();
+            tree_request_render();
         } else if (config.focus_on_window_activation == FOWA_URGENT || (config.focus_on_window_activation == FOWA_SMART && !workspace_is_visible(workspace))) {
             DLOG("Marking con = %p urgent\n", con);
             con_set_urgency(con, true);
-            tree_render();
+            tree_request_render();
         } else {
             DLOG("Ignoring request for con = %p.\n", con);
         }
@@ -453,7 +453,7 @@ static void handle_screen_change(xcb_generic_event_t *e) {
 
     scratchpad_fix_resolution();
 
-    ipc_send_event("output", I3_IPC_EVENT_OUTPUT, "{\"change\":\"unspecified\"}");
+    ipc_send_event(I3_IPC_EVENT_OUTPUT, "{\"change\":\"unspecified\"}");
 }
 
 /*
@@ -497,7 +497,7 @@ static void handle_unmap_notify_event(xcb_unmap_notify_event_t *event) {
     xcb_delete_property(conn, event->window, A__NET_WM_STATE);
 
     tree_close_internal(con, DONT_KILL_WINDOW, false);
-    tree_render();
+    tree_request_render();
 
 ignore_end:
     /* If the client (as opposed to i3) destroyed or unmapped a window, an
@@ -567,8 +567,11 @@ static bool handle_windowname_change(Con *con, xcb_get_property_reply_t *prop) {
 
     x_push_changes(croot);
 
-    if (window_name_changed(con->window, old_name))
+    if (window_name_changed(con->window, old_name)) {
         ipc_send_window_event("title", con);
+        tree_delta_property(con, TREE_DELTA_NAME);
+        tree_delta_property(con, TREE_DELTA_WINDOW_PROPERTIES);
+    }
 
     FREE(old_name);
 
@@ -589,8 +592,11 @@ static bool handle_windowname_change_legacy(Con *con, xcb_get_property_reply_t *
 
     x_push_changes(croot);
 
-    if (window_name_changed(con->window, old_name))
+    if (window_name_changed(con->window, old_name)) {
         ipc_send_window_event("title", con);
+        tree_delta_property(con, TREE_DELTA_NAME);
+        tree_delta_property(con, TREE_DELTA_WINDOW_PROPERTIES);
+    }
 
     FREE(old_name);
 
@@ -603,6 +609,7 @@ static bool handle_windowname_change_legacy(Con *con, xcb_get_property_reply_t *
  */
 static bool handle_windowrole_change(Con *con, xcb_get_property_reply_t *prop) {
     window_update_role(con->window, prop);
+    tree_delta_property(con, TREE_DELTA_WINDOW_PROPERTIES);
 
     con = remanage_window(con);
 
@@ -625,8 +632,7 @@ static void handle_expose_event(xcb_expose_event_t *event) {
 
     /* Since we render to our surface on every change anyways, expose events
      * only tell us that the X server lost (parts of) the window contents. */
-    draw_util_copy_surface(&(parent->frame_buffer), &(parent->frame),
-                           0, 0, 0, 0, parent->rect.width, parent->rect.height);
+    x_repaint_region(parent, (Rect){event->x, event->y, event->width, event->height});
     xcb_flush(conn);
 }
 
@@ -703,12 +709,13 @@ static void handle_client_message(xcb_client_message_event_t *event) {
                 con->sticky = !con->sticky;
 
             DLOG("New sticky status for con = %p is %i.\n", con, con->sticky);
+            tree_delta_property(con, TREE_DELTA_STICKY);
             ewmh_update_sticky(con->window->id, con->sticky);
             output_push_sticky_windows(focused);
             ewmh_update_wm_desktop();
         }
 
-        tree_render();
+        tree_request_render();
     } else if (event->type == A__NET_ACTIVE_WINDOW) {
         if (event->format != 32)
             return;
@@ -763,7 +770,7 @@ static void handle_client_message(xcb_client_message_event_t *event) {
                 DLOG("Ignoring request for con = %p.\n", con);
         }
 
-        tree_render();
+        tree_request_render();
     } else if (event->type == A_I3_SYNC) {
         xcb_window_t window = event->data.data32[0];
         uint32_t rnd = event->data.data32[1];
@@ -825,7 +832,7 @@ static void handle_client_message(xcb_client_message_event_t *event) {
 
         DLOG("Handling request to focus workspace %s\n", ws->name);
         workspace_show(ws);
-        tree_render();
+        tree_request_render();
     } else if (event->type == A__NET_WM_DESKTOP) {
         uint32_t index = event->data.data32[0];
         DLOG("Request to move window %d to EWMH desktop index %d\n", event->window, index);
@@ -845,6 +852,7 @@ static void handle_client_message(xcb_client_message_event_t *event) {
                 con->floating = FLOATING_AUTO_ON;
 
                 con->sticky = true;
+                tree_delta_property(con, TREE_DELTA_STICKY);
                 ewmh_update_sticky(con->window->id, true);
                 output_push_sticky_windows(focused);
             }
@@ -858,7 +866,7 @@ static void handle_client_message(xcb_client_message_event_t *event) {
             con_move_to_workspace(con, ws, true, false, false);
         }
 
-        tree_render();
+        tree_request_render();
         ewmh_update_wm_desktop();
     } else if (event->type == A__NET_CLOSE_WINDOW) {
         /*
@@ -874,7 +882,7 @@ static void handle_client_message(xcb_client_message_event_t *event) {
                 last_timestamp = event->data.data32[0];
 
             tree_close_internal(con, KILL_WINDOW, false);
-            tree_render();
+            tree_request_render();
         } else {
             DLOG("Couldn't find con for _NET_CLOSE_WINDOW request. (window = %d)\n", event->window);
         }
@@ -962,7 +970,7 @@ static bool handle_normal_hints(Con *con, xcb_get_property_reply_t *reply) {
         Con *floating = con_inside_floating(con);
         if (floating) {
             floating_check_size(con, false);
-            tree_render();
+            tree_request_render();
         }
     }
 
@@ -978,7 +986,7 @@ static bool handle_hints(Con *con, xcb_get_property_reply_t *reply) {
     bool urgency_hint;
     window_update_hints(con->window, reply, &urgency_hint);
     con_set_urgency(con, urgency_hint);
-    tree_render();
+    tree_request_render();
     return true;
 }
 
@@ -1055,7 +1063,7 @@ static void handle_focus_in(xcb_focus_in_event_t *event) {
 
     /* We update focused_id because we don’t need to set focus again */
     focused_id = event->event;
-    tree_render();
+    tree_request_render();
 }
 
 /*
@@ -1082,6 +1090,8 @@ static void handle_configure_notify(xcb_configure_notify_event_t *event) {
  */
 static bool handle_class_change(Con *con, xcb_get_property_reply_t *prop) {
     window_update_class(con->window, prop);
+    con_invalidate_tree_representation(con);
+    tree_delta_property(con, TREE_DELTA_WINDOW_PROPERTIES);
     con = remanage_window(con);
     return true;
 }
@@ -1092,6 +1102,7 @@ static bool handle_class_change(Con *con, xcb_get_property_reply_t *prop) {
  */
 static bool handle_machine_change(Con *con, xcb_get_property_reply_t *prop) {
     window_update_machine(con->window, prop);
+    tree_delta_property(con, TREE_DELTA_WINDOW_PROPERTIES);
     con = remanage_window(con);
     return true;
 }
@@ -1142,13 +1153,13 @@ static bool handle_strut_partial_change(Con *con, xcb_get_property_reply_t *prop
         con->window->dock = W_DOCK_BOTTOM;
     } else {
         DLOG("Ignoring invalid reserved edges (_NET_WM_STRUT_PARTIAL), using position as fallback:\n");
-        if (con->geometry.y < (search_at->rect.height / 2)) {
+        if (con->cold->geometry.y < (search_at->rect.height / 2)) {
             DLOG("geom->y = %d < rect.height / 2 = %d, it is a top dock client\n",
-                 con->geometry.y, (search_at->rect.height / 2));
+                 con->cold->geometry.y, (search_at->rect.height / 2));
             con->window->dock = W_DOCK_TOP;
         } else {
             DLOG("geom->y = %d >= rect.height / 2 = %d, it is a bottom dock client\n",
-                 con->geometry.y, (search_at->rect.height / 2));
+                 con->cold->geometry.y, (search_at->rect.height / 2));
             con->window->dock = W_DOCK_BOTTOM;
         }
     }
@@ -1161,7 +1172,7 @@ static bool handle_strut_partial_change(Con *con, xcb_get_property_reply_t *prop
     con_detach(con);
     con_attach(con, dockarea, true);
 
-    tree_render();
+    tree_request_render();
 
     return true;
 }
@@ -1187,6 +1198,7 @@ static bool handle_i3_floating(Con *con, xcb_get_property_reply_t *prop) {
 
 static bool handle_windowicon_change(Con *con, xcb_get_property_reply_t *prop) {
     window_update_icon(con->window, prop);
+    x_invalidate_title_strip(con);
 
     x_push_changes(croot);
 
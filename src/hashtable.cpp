@@ -0,0 +1,297 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved dynamic tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * hashtable.c: Small open-addressing hash tables used to index the layout
+ *              tree (for example X11 window IDs to containers).
+ *
+ */
+#include "all.hpp"
+
+/* Initial number of slots. Must be a power of two. */
+#define ID_TABLE_MIN_CAPACITY 64
+
+/*
+ * Fibonacci hashing: X11 IDs are handed out sequentially within a client's
+ * resource range, so we spread them over the table by multiplying with
+ * 2^32 / phi.
+ *
+ */
+static inline uint32_t id_slot(const id_table_t *table, uint32_t key) {
+    return (key * 2654435769u) & (table->capacity - 1);
+}
+
+static void id_table_resize(id_table_t *table, uint32_t capacity) {
+    uint32_t *old_keys = table->keys;
+    void **old_values = table->values;
+    uint32_t old_capacity = table->capacity;
+
+    table->keys = scalloc(capacity, sizeof(uint32_t));
+    table->values = scalloc(capacity, sizeof(void *));
+    table->capacity = capacity;
+    table->count = 0;
+
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old_keys[i] != 0) {
+            id_table_insert(table, old_keys[i], old_values[i]);
+        }
+    }
+
+    free(old_keys);
+    free(old_values);
+}
+
+/*
+ * Inserts (or replaces) the value for the given key.
+ *
+ */
+void id_table_insert(id_table_t *table, uint32_t key, void *value) {
+    assert(key != 0);
+
+    /* Keep the load factor below 3/4. */
+    if (table->capacity == 0) {
+        id_table_resize(table, ID_TABLE_MIN_CAPACITY);
+    } else if ((table->count + 1) * 4 > table->capacity * 3) {
+        id_table_resize(table, table->capacity * 2);
+    }
+
+    uint32_t mask = table->capacity - 1;
+    for (uint32_t i = id_slot(table, key);; i = (i + 1) & mask) {
+        if (table->keys[i] == key) {
+            table->values[i] = value;
+            return;
+        }
+        if (table->keys[i] == 0) {
+            table->keys[i] = key;
+            table->values[i] = value;
+            table->count++;
+            return;
+        }
+    }
+}
+
+/*
+ * Returns the value stored for the given key or NULL if there is none.
+ *
+ */
+void *id_table_lookup(const id_table_t *table, uint32_t key) {
+    if (table->count == 0 || key == 0) {
+        return NULL;
+    }
+
+    uint32_t mask = table->capacity - 1;
+    for (uint32_t i = id_slot(table, key); table->keys[i] != 0; i = (i + 1) & mask) {
+        if (table->keys[i] == key) {
+            return table->values[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Removes the given key from the table. Returns the value which was stored for
+ * it or NULL if the key was not present.
+ *
+ */
+void *id_table_remove(id_table_t *table, uint32_t key) {
+    if (table->count == 0 || key == 0) {
+        return NULL;
+    }
+
+    uint32_t mask = table->capacity - 1;
+    uint32_t i = id_slot(table, key);
+    while (table->keys[i] != key) {
+        if (table->keys[i] == 0) {
+            return NULL;
+        }
+        i = (i + 1) & mask;
+    }
+
+    void *value = table->values[i];
+    table->count--;
+
+    /* Backward-shift deletion: move every following entry of the probe
+     * sequence which would be unreachable with a hole at i. */
+    uint32_t hole = i;
+    for (uint32_t j = (i + 1) & mask; table->keys[j] != 0; j = (j + 1) & mask) {
+        uint32_t home = id_slot(table, table->keys[j]);
+        /* The entry at j may move into the hole only if its home slot is not
+         * cyclically within (hole, j]. */
+        bool reachable = (hole <= j) ? (hole < home && home <= j)
+                                     : (hole < home || home <= j);
+        if (reachable) {
+            continue;
+        }
+        table->keys[hole] = table->keys[j];
+        table->values[hole] = table->values[j];
+        hole = j;
+    }
+    table->keys[hole] = 0;
+    table->values[hole] = NULL;
+
+    return value;
+}
+
+/*
+ * Frees all memory used by the table and resets it to an empty table.
+ *
+ */
+void id_table_free(id_table_t *table) {
+    FREE(table->keys);
+    FREE(table->values);
+    table->capacity = 0;
+    table->count = 0;
+}
+
+/*
+ * FNV-1a, which is good enough for the short strings (marks, names) we store.
+ *
+ */
+static uint32_t str_hash(const char *key) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char *)key; *c != '\0'; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void str_table_resize(str_table_t *table, uint32_t capacity) {
+    const char **old_keys = table->keys;
+    uint32_t *old_hashes = table->hashes;
+    void **old_values = table->values;
+    uint32_t old_capacity = table->capacity;
+
+    table->keys = scalloc(capacity, sizeof(const char *));
+    table->hashes = scalloc(capacity, sizeof(uint32_t));
+    table->values = scalloc(capacity, sizeof(void *));
+    table->capacity = capacity;
+
+    uint32_t mask = capacity - 1;
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old_keys[i] == NULL) {
+            continue;
+        }
+        uint32_t j = old_hashes[i] & mask;
+        while (table->keys[j] != NULL) {
+            j = (j + 1) & mask;
+        }
+        table->keys[j] = old_keys[i];
+        table->hashes[j] = old_hashes[i];
+        table->values[j] = old_values[i];
+    }
+
+    free(old_keys);
+    free(old_hashes);
+    free(old_values);
+}
+
+/*
+ * Returns the slot of the given key or -1 if it is not in the table.
+ *
+ */
+static int64_t str_table_find(const str_table_t *table, const char *key, uint32_t hash) {
+    if (table->count == 0) {
+        return -1;
+    }
+
+    uint32_t mask = table->capacity - 1;
+    for (uint32_t i = hash & mask; table->keys[i] != NULL; i = (i + 1) & mask) {
+        if (table->hashes[i] == hash && strcmp(table->keys[i], key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Inserts (or replaces) the value for the given key.
+ *
+ */
+void str_table_insert(str_table_t *table, const char *key, void *value) {
+    assert(key != NULL);
+
+    uint32_t hash = str_hash(key);
+    int64_t slot = str_table_find(table, key, hash);
+    if (slot != -1) {
+        table->keys[slot] = key;
+        table->values[slot] = value;
+        return;
+    }
+
+    /* Keep the load factor below 3/4. */
+    if (table->capacity == 0) {
+        str_table_resize(table, ID_TABLE_MIN_CAPACITY);
+    } else if ((table->count + 1) * 4 > table->capacity * 3) {
+        str_table_resize(table, table->capacity * 2);
+    }
+
+    uint32_t mask = table->capacity - 1;
+    uint32_t i = hash & mask;
+    while (table->keys[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    table->keys[i] = key;
+    table->hashes[i] = hash;
+    table->values[i] = value;
+    table->count++;
+}
+
+/*
+ * Returns the value stored for the given key or NULL if there is none.
+ *
+ */
+void *str_table_lookup(const str_table_t *table, const char *key) {
+    int64_t slot = str_table_find(table, key, str_hash(key));
+    return (slot == -1 ? NULL : table->values[slot]);
+}
+
+/*
+ * Removes the given key from the table. Returns the value which was stored for
+ * it or NULL if the key was not present.
+ *
+ */
+void *str_table_remove(str_table_t *table, const char *key) {
+    int64_t slot = str_table_find(table, key, str_hash(key));
+    if (slot == -1) {
+        return NULL;
+    }
+
+    void *value = table->values[slot];
+    table->count--;
+
+    /* Backward-shift deletion, see id_table_remove(). */
+    uint32_t mask = table->capacity - 1;
+    uint32_t hole = slot;
+    for (uint32_t j = (hole + 1) & mask; table->keys[j] != NULL; j = (j + 1) & mask) {
+        uint32_t home = table->hashes[j] & mask;
+        bool reachable = (hole <= j) ? (hole < home && home <= j)
+                                     : (hole < home || home <= j);
+        if (reachable) {
+            continue;
+        }
+        table->keys[hole] = table->keys[j];
+        table->hashes[hole] = table->hashes[j];
+        table->values[hole] = table->values[j];
+        hole = j;
+    }
+    table->keys[hole] = NULL;
+    table->values[hole] = NULL;
+
+    return value;
+}
+
+/*
+ * Frees all memory used by the table (but not the keys) and resets it to an
+ * empty table.
+ *
+ */
+void str_table_free(str_table_t *table) {
+    FREE(table->keys);
+    FREE(table->hashes);
+    FREE(table->values);
+    table->capacity = 0;
+    table->count = 0;
+}
@@ -14,9 +14,11 @@
 #include <ev.h>
 #include <fcntl.h>
 #include <libgen.h>
+#include <limits.h>
 #include <locale.h>
 #include <stdint.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
@@ -36,23 +38,166 @@ void ipc_set_kill_timeout(ev_tstamp new) {
     kill_timeout = new;
 }
 
+/* Clients with more than this many bytes of events queued are disconnected
+ * when an event is sent to them (0 means no limit). */
+static size_t high_water_mark = 0;
+
+void ipc_set_high_water_mark(size_t bytes) {
+    high_water_mark = bytes;
+}
+
+/* Maximum number of messages written with one writev() call. */
+#define IPC_MAX_IOV 64
+
+/* The names of the events, indexed by event type (without
+ * I3_IPC_EVENT_MASK). */
+static const char *event_names[] = {
+    "workspace",
+    "output",
+    "mode",
+    "window",
+    "barconfig_update",
+    "binding",
+    "shutdown",
+    "tick",
+    "tree",
+};
+#define NUM_EVENTS (sizeof(event_names) / sizeof(event_names[0]))
+
+/* The number of clients subscribed to each event. */
+static int event_subscribers[NUM_EVENTS];
+
+/*
+ * Creates a message with the corresponding header for the given payload. The
+ * caller holds the only reference.
+ *
+ */
+static ipc_message *ipc_new_message(size_t size, const uint32_t message_type, const uint8_t *payload) {
+    const i3_ipc_header_t header = {
+        .magic = {'i', '3', '-', 'i', 'p', 'c'},
+        .size = size,
+        .type = message_type};
+    const size_t header_size = sizeof(i3_ipc_header_t);
+
+    ipc_message *message = smalloc(sizeof(ipc_message) + header_size + size);
+    message->refcount = 1;
+    message->event = (message_type & I3_IPC_EVENT_MASK) != 0;
+    message->size = header_size + size;
+    message->data = (uint8_t *)(message + 1);
+    memcpy(message->data, ((void *)&header), header_size);
+    memcpy(message->data + header_size, payload, size);
+    return message;
+}
+
+static void ipc_unref_message(ipc_message *message) {
+    if (--(message->refcount) == 0) {
+        free(message);
+    }
+}
+
+/*
+ * Subtracts bytes of the given queued message from the client's counters.
+ *
+ */
+static void ipc_pending_consumed(ipc_client *client, const ipc_message *message, size_t bytes) {
+    client->pending_size -= bytes;
+    if (message->event) {
+        client->pending_event_size -= bytes;
+    }
+}
+
 /*
- * Try to write the contents of the pending buffer to the client's subscription
- * socket. Will set, reset or clear the timeout and io write callbacks depending
- * on the result of the write operation.
+ * Removes the first message from the client's queue.
+ *
+ */
+static void ipc_pop_pending(ipc_client *client) {
+    ipc_pending_message *first = TAILQ_FIRST(&(client->pending));
+    TAILQ_REMOVE(&(client->pending), first, pending);
+    ipc_pending_consumed(client, first->message, first->message->size - client->pending_offset);
+    ipc_unref_message(first->message);
+    free(first);
+    client->pending_offset = 0;
+}
+
+/*
+ * Writes as many pending messages as possible without blocking, using one
+ * writev() call for up to IPC_MAX_IOV messages. Returns the number of bytes
+ * written or -1 on error.
+ *
+ */
+static ssize_t ipc_write_pending(ipc_client *client) {
+    size_t written = 0;
+    while (!TAILQ_EMPTY(&(client->pending))) {
+        struct iovec iov[IPC_MAX_IOV];
+        int iovcnt = 0;
+        size_t total = 0;
+        size_t offset = client->pending_offset;
+        ipc_pending_message *walk;
+        TAILQ_FOREACH (walk, &(client->pending), pending) {
+            if (iovcnt == IPC_MAX_IOV)
+                break;
+            iov[iovcnt].iov_base = walk->message->data + offset;
+            iov[iovcnt].iov_len = walk->message->size - offset;
+            total += iov[iovcnt].iov_len;
+            iovcnt++;
+            offset = 0;
+        }
+
+        const ssize_t n = writev(client->fd, iov, iovcnt);
+        if (n == -1) {
+            if (errno == EAGAIN) {
+                break;
+            } else if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        written += (size_t)n;
+
+        /* Advance through the queue, dropping the messages which have been
+         * written completely. */
+        size_t left = (size_t)n;
+        while (left > 0) {
+            ipc_pending_message *first = TAILQ_FIRST(&(client->pending));
+            const size_t remaining = first->message->size - client->pending_offset;
+            if (left < remaining) {
+                client->pending_offset += left;
+                ipc_pending_consumed(client, first->message, left);
+                break;
+            }
+            left -= remaining;
+            ipc_pop_pending(client);
+        }
+
+        /* A short write means that the socket buffer is full. */
+        if ((size_t)n < total) {
+            break;
+        }
+    }
+    return written;
+}
+
+/*
+ * Try to write the pending messages to the client's subscription socket.
+ * Will set, reset or clear the timeout and io write callbacks depending on the
+ * result of the write operation.
  *
  */
 static void ipc_push_pending(ipc_client *client) {
-    const ssize_t result = writeall_nonblock(client->fd, client->buffer, client->buffer_size);
-    if (result < 0) {
+    /* The client is disconnected by its timeout, which must not be re-armed
+     * (or cleared) here. */
+    if (client->killed) {
+        return;
+    }
+
+    const ssize_t written = ipc_write_pending(client);
+    if (written < 0) {
         return;
     }
 
-    if ((size_t)result == client->buffer_size) {
+    if (TAILQ_EMPTY(&(client->pending))) {
         /* Everything was written successfully: clear the timer and stop the io
          * callback. */
-        FREE(client->buffer);
-        client->buffer_size = 0;
         if (client->timeout) {
             ev_timer_stop(main_loop, client->timeout);
             FREE(client->timeout);
@@ -72,48 +217,49 @@ static void ipc_push_pending(ipc_client *client) {
         client->timeout = timeout;
         ev_set_priority(timeout, EV_MINPRI);
         ev_timer_start(main_loop, client->timeout);
-    } else if (result > 0) {
+    } else if (written > 0) {
         /* Keep the old timeout when nothing is written. Otherwise, we would
          * keep a dead connection by continuously renewing its timeouts. */
         ev_timer_stop(main_loop, client->timeout);
         ev_timer_set(client->timeout, kill_timeout, 0.0);
         ev_timer_start(main_loop, client->timeout);
     }
-    if (result == 0) {
-        return;
-    }
-
-    /* Shift the buffer to the left and reduce the allocated space. */
-    client->buffer_size -= (size_t)result;
-    memmove(client->buffer, client->buffer + result, client->buffer_size);
-    client->buffer = srealloc(client->buffer, client->buffer_size);
 }
 
 /*
- * Given a message and a message type, create the corresponding header, merge it
- * with the message and append it to the given client's output buffer. Also,
- * send the message if the client's buffer was empty.
+ * Appends the message to the given client's queue (taking a reference). Also,
+ * send the message if the client's queue was empty.
  *
  */
-static void ipc_send_client_message(ipc_client *client, size_t size, const uint32_t message_type, const uint8_t *payload) {
-    const i3_ipc_header_t header = {
-        .magic = {'i', '3', '-', 'i', 'p', 'c'},
-        .size = size,
-        .type = message_type};
-    const size_t header_size = sizeof(i3_ipc_header_t);
-    const size_t message_size = header_size + size;
-
-    const bool push_now = (client->buffer_size == 0);
-    client->buffer = srealloc(client->buffer, client->buffer_size + message_size);
-    memcpy(client->buffer + client->buffer_size, ((void *)&header), header_size);
-    memcpy(client->buffer + client->buffer_size + header_size, payload, size);
-    client->buffer_size += message_size;
+static void ipc_queue_message(ipc_client *client, ipc_message *message) {
+    const bool push_now = TAILQ_EMPTY(&(client->pending));
+
+    ipc_pending_message *pending = smalloc(sizeof(ipc_pending_message));
+    pending->message = message;
+    message->refcount++;
+    TAILQ_INSERT_TAIL(&(client->pending), pending, pending);
+    client->pending_size += message->size;
+    if (message->event) {
+        client->pending_event_size += message->size;
+    }
 
     if (push_now) {
         ipc_push_pending(client);
     }
 }
 
+/*
+ * Given a message and a message type, create the corresponding header, merge it
+ * with the message and append it to the given client's output queue. Also,
+ * send the message if the client's queue was empty.
+ *
+ */
+static void ipc_send_client_message(ipc_client *client, size_t size, const uint32_t message_type, const uint8_t *payload) {
+    ipc_message *message = ipc_new_message(size, message_type, payload);
+    ipc_queue_message(client, message);
+    ipc_unref_message(message);
+}
+
 static void free_ipc_client(ipc_client *client, int exempt_fd) {
     if (client->fd != exempt_fd) {
         DLOG("Disconnecting client on fd %d\n", client->fd);
@@ -129,37 +275,92 @@ static void free_ipc_client(ipc_client *client, int exempt_fd) {
         FREE(client->timeout);
     }
 
-    free(client->buffer);
+    while (!TAILQ_EMPTY(&(client->pending))) {
+        ipc_pop_pending(client);
+    }
+    free(client->input);
 
-    for (int i = 0; i < client->num_events; i++) {
-        free(client->events[i]);
+    for (size_t i = 0; i < NUM_EVENTS; i++) {
+        if (client->events & (1U << i)) {
+            event_subscribers[i]--;
+        }
     }
-    free(client->events);
     TAILQ_REMOVE(&all_clients, client, clients);
     free(client);
 }
 
+/*
+ * Disconnects a client which has more than high_water_mark bytes of events
+ * queued. This is done from the client's timeout, because we might be handling
+ * a message of that very client right now.
+ *
+ */
+static void ipc_kill_client_soon(ipc_client *client) {
+    ELOG("client %p on fd %d has %zu bytes of events queued (more than %zu), killing\n",
+         client, client->fd, client->pending_event_size, high_water_mark);
+
+    client->killed = true;
+    ev_io_stop(main_loop, client->write_callback);
+
+    if (client->timeout == NULL) {
+        client->timeout = scalloc(1, sizeof(struct ev_timer));
+        ev_timer_init(client->timeout, ipc_client_timeout, 0., 0.);
+        client->timeout->data = client;
+    } else {
+        ev_timer_stop(main_loop, client->timeout);
+        ev_timer_set(client->timeout, 0., 0.);
+    }
+    ev_timer_start(main_loop, client->timeout);
+}
+
+/*
+ * Returns true if at least one IPC client is subscribed to the given event
+ * type (I3_IPC_EVENT_*). Callers can use this to avoid generating events
+ * nobody will receive.
+ *
+ */
+bool ipc_has_subscribers(uint32_t message_type) {
+    const uint32_t event = message_type & ~I3_IPC_EVENT_MASK;
+    assert(event < NUM_EVENTS);
+    return event_subscribers[event] > 0;
+}
+
 /*
  * Sends the specified event to all IPC clients which are currently connected
  * and subscribed to this kind of event.
  *
  */
-void ipc_send_event(const char *event, uint32_t message_type, const char *payload) {
+void ipc_send_event(uint32_t message_type, const char *payload) {
+    if (!ipc_has_subscribers(message_type)) {
+        return;
+    }
+
+    /* The message is serialized once and shared by all clients. */
+    ipc_message *message = ipc_new_message(strlen(payload), message_type, (const uint8_t *)payload);
     ipc_client *current;
     TAILQ_FOREACH (current, &all_clients, clients) {
-        for (int i = 0; i < current->num_events; i++) {
-            if (strcasecmp(current->events[i], event) == 0) {
-                ipc_send_client_message(current, strlen(payload), message_type, (uint8_t *)payload);
-                break;
+        if (current->events & IPC_EVENT_BIT(message_type)) {
+            ipc_queue_message(current, message);
+
+            /* Only events count: replies to the client's own requests
+             * (e.g. a large GET_TREE) must not get it disconnected. */
+            if (high_water_mark > 0 && !current->killed &&
+                current->pending_event_size > high_water_mark) {
+                ipc_kill_client_soon(current);
             }
         }
     }
+    ipc_unref_message(message);
 }
 
 /*
  * For shutdown events, we send the reason for the shutdown.
  */
 static void ipc_send_shutdown_event(shutdown_reason_t reason) {
+    if (!ipc_has_subscribers(I3_IPC_EVENT_SHUTDOWN)) {
+        return;
+    }
+
     yajl_gen gen = ygenalloc();
     y(map_open);
 
@@ -177,7 +378,7 @@ static void ipc_send_shutdown_event(shutdown_reason_t reason) {
     ylength length;
 
     y(get_buf, &payload, &length);
-    ipc_send_event("shutdown", I3_IPC_EVENT_SHUTDOWN, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_SHUTDOWN, (const char *)payload);
 
     y(free);
 }
@@ -217,10 +418,15 @@ IPC_HANDLER(run_command) {
     free(command);
 
     if (result->needs_tree_render)
-        tree_render();
+        tree_request_render();
 
     command_result_free(result);
 
+    /* Clients expect the effects of the command to be visible once they get
+     * the reply. */
+    tree_flush_render();
+    tree_delta_flush();
+
     const unsigned char *reply;
     ylength length;
     yajl_gen_get_buf(gen, &reply, &length);
@@ -335,214 +541,344 @@ static void dump_binding(yajl_gen gen, Binding *bind) {
     y(map_close);
 }
 
-void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
+/* The keys of a node which can be selected with the "fields" of a GET_TREE
+ * request, indexed by dump_field_t. "nodes" and "floating_nodes" are selected
+ * with the "depth" instead. */
+static const char *dump_field_names[] = {
+    "id",
+    "type",
+    "orientation",
+    "scratchpad_state",
+    "percent",
+    "urgent",
+    "marks",
+    "focused",
+    "output",
+    "layout",
+    "workspace_layout",
+    "last_split_layout",
+    "border",
+    "current_border_width",
+    "rect",
+    "deco_rect",
+    "window_rect",
+    "geometry",
+    "name",
+    "title_format",
+    "window_icon_padding",
+    "num",
+    "window",
+    "window_type",
+    "window_properties",
+    "focus",
+    "fullscreen_mode",
+    "sticky",
+    "floating",
+    "swallows",
+    "depth",
+    "previous_workspace_name",
+};
+#define NUM_DUMP_FIELDS (sizeof(dump_field_names) / sizeof(dump_field_names[0]))
+
+typedef enum {
+    DF_ID = 0,
+    DF_TYPE,
+    DF_ORIENTATION,
+    DF_SCRATCHPAD_STATE,
+    DF_PERCENT,
+    DF_URGENT,
+    DF_MARKS,
+    DF_FOCUSED,
+    DF_OUTPUT,
+    DF_LAYOUT,
+    DF_WORKSPACE_LAYOUT,
+    DF_LAST_SPLIT_LAYOUT,
+    DF_BORDER,
+    DF_CURRENT_BORDER_WIDTH,
+    DF_RECT,
+    DF_DECO_RECT,
+    DF_WINDOW_RECT,
+    DF_GEOMETRY,
+    DF_NAME,
+    DF_TITLE_FORMAT,
+    DF_WINDOW_ICON_PADDING,
+    DF_NUM,
+    DF_WINDOW,
+    DF_WINDOW_TYPE,
+    DF_WINDOW_PROPERTIES,
+    DF_FOCUS,
+    DF_FULLSCREEN_MODE,
+    DF_STICKY,
+    DF_FLOATING,
+    DF_SWALLOWS,
+    DF_DEPTH,
+    DF_PREVIOUS_WORKSPACE_NAME,
+} dump_field_t;
+
+#define DUMP_FIELDS_ALL (~(uint64_t)0)
+
+/* Selects what dump_node_depth() writes. */
+typedef struct dump_options {
+    bool inplace_restart;
+    /* Bitmask of the dump_field_t keys to write. */
+    uint64_t fields;
+} dump_options_t;
+
+#define WANT(field) (options->fields & ((uint64_t)1 << (field)))
+
+/*
+ * Dumps the selected fields of the container. Its children are only dumped if
+ * depth is not 0 (with depth - 1), a negative depth dumps the whole subtree.
+ *
+ */
+static void dump_node_depth(yajl_gen gen, struct Con *con, const dump_options_t *options, int depth) {
+    const bool inplace_restart = options->inplace_restart;
+
     y(map_open);
-    ystr("id");
-    y(integer, (uintptr_t)con);
+    if (WANT(DF_ID)) {
+        ystr("id");
+        y(integer, con->id);
+    }
 
-    ystr("type");
-    switch (con->type) {
-        case CT_ROOT:
-            ystr("root");
-            break;
-        case CT_OUTPUT:
-            ystr("output");
-            break;
-        case CT_CON:
-            ystr("con");
-            break;
-        case CT_FLOATING_CON:
-            ystr("floating_con");
-            break;
-        case CT_WORKSPACE:
-            ystr("workspace");
-            break;
-        case CT_DOCKAREA:
-            ystr("dockarea");
-            break;
+    if (WANT(DF_TYPE)) {
+        ystr("type");
+        switch (con->type) {
+            case CT_ROOT:
+                ystr("root");
+                break;
+            case CT_OUTPUT:
+                ystr("output");
+                break;
+            case CT_CON:
+                ystr("con");
+                break;
+            case CT_FLOATING_CON:
+                ystr("floating_con");
+                break;
+            case CT_WORKSPACE:
+                ystr("workspace");
+                break;
+            case CT_DOCKAREA:
+                ystr("dockarea");
+                break;
+        }
     }
 
     /* provided for backwards compatibility only. */
-    ystr("orientation");
-    if (!con_is_split(con))
-        ystr("none");
-    else {
-        if (con_orientation(con) == HORIZ)
-            ystr("horizontal");
-        else
-            ystr("vertical");
+    if (WANT(DF_ORIENTATION)) {
+        ystr("orientation");
+        if (!con_is_split(con))
+            ystr("none");
+        else {
+            if (con_orientation(con) == HORIZ)
+                ystr("horizontal");
+            else
+                ystr("vertical");
+        }
     }
 
-    ystr("scratchpad_state");
-    switch (con->scratchpad_state) {
-        case SCRATCHPAD_NONE:
-            ystr("none");
-            break;
-        case SCRATCHPAD_FRESH:
-            ystr("fresh");
-            break;
-        case SCRATCHPAD_CHANGED:
-            ystr("changed");
-            break;
+    if (WANT(DF_SCRATCHPAD_STATE)) {
+        ystr("scratchpad_state");
+        switch (con->scratchpad_state) {
+            case SCRATCHPAD_NONE:
+                ystr("none");
+                break;
+            case SCRATCHPAD_FRESH:
+                ystr("fresh");
+                break;
+            case SCRATCHPAD_CHANGED:
+                ystr("changed");
+                break;
+        }
     }
 
-    ystr("percent");
-    if (con->percent == 0.0)
-        y(null);
-    else
-        y(double, con->percent);
+    if (WANT(DF_PERCENT)) {
+        ystr("percent");
+        if (con->percent == 0.0)
+            y(null);
+        else
+            y(double, con->percent);
+    }
 
-    ystr("urgent");
-    y(bool, con->urgent);
+    if (WANT(DF_URGENT)) {
+        ystr("urgent");
+        y(bool, con->urgent);
+    }
 
-    ystr("marks");
-    y(array_open);
-    mark_t *mark;
-    TAILQ_FOREACH (mark, &(con->marks_head), marks) {
-        ystr(mark->name);
+    if (WANT(DF_MARKS)) {
+        ystr("marks");
+        y(array_open);
+        mark_t *mark;
+        TAILQ_FOREACH (mark, &(con->cold->marks_head), marks) {
+            ystr(mark->name);
+        }
+        y(array_close);
     }
-    y(array_close);
 
-    ystr("focused");
-    y(bool, (con == focused));
+    if (WANT(DF_FOCUSED)) {
+        ystr("focused");
+        y(bool, (con == focused));
+    }
 
-    if (con->type != CT_ROOT && con->type != CT_OUTPUT) {
+    if (WANT(DF_OUTPUT) && con->type != CT_ROOT && con->type != CT_OUTPUT) {
         ystr("output");
         ystr(con_get_output(con)->name);
     }
 
-    ystr("layout");
-    switch (con->layout) {
-        case L_DEFAULT:
-            DLOG("About to dump layout=default, this is a bug in the code.\n");
-            assert(false);
-            break;
-        case L_SPLITV:
-            ystr("splitv");
-            break;
-        case L_SPLITH:
-            ystr("splith");
-            break;
-        case L_STACKED:
-            ystr("stacked");
-            break;
-        case L_TABBED:
-            ystr("tabbed");
-            break;
-        case L_DOCKAREA:
-            ystr("dockarea");
-            break;
-        case L_OUTPUT:
-            ystr("output");
-            break;
+    if (WANT(DF_LAYOUT)) {
+        ystr("layout");
+        switch (con->layout) {
+            case L_DEFAULT:
+                DLOG("About to dump layout=default, this is a bug in the code.\n");
+                assert(false);
+                break;
+            case L_SPLITV:
+                ystr("splitv");
+                break;
+            case L_SPLITH:
+                ystr("splith");
+                break;
+            case L_STACKED:
+                ystr("stacked");
+                break;
+            case L_TABBED:
+                ystr("tabbed");
+                break;
+            case L_DOCKAREA:
+                ystr("dockarea");
+                break;
+            case L_OUTPUT:
+                ystr("output");
+                break;
+        }
     }
 
-    ystr("workspace_layout");
-    switch (con->workspace_layout) {
-        case L_DEFAULT:
-            ystr("default");
-            break;
-        case L_STACKED:
-            ystr("stacked");
-            break;
-        case L_TABBED:
-            ystr("tabbed");
-            break;
-        default:
-            DLOG("About to dump workspace_layout=%d (none of default/stacked/tabbed), this is a bug.\n", con->workspace_layout);
-            assert(false);
-            break;
+    if (WANT(DF_WORKSPACE_LAYOUT)) {
+        ystr("workspace_layout");
+        switch (con->workspace_layout) {
+            case L_DEFAULT:
+                ystr("default");
+                break;
+            case L_STACKED:
+                ystr("stacked");
+                break;
+            case L_TABBED:
+                ystr("tabbed");
+                break;
+            default:
+                DLOG("About to dump workspace_layout=%d (none of default/stacked/tabbed), this is a bug.\n", con->workspace_layout);
+                assert(false);
+                break;
+        }
     }
 
-    ystr("last_split_layout");
-    switch (con->layout) {
-        case L_SPLITV:
-            ystr("splitv");
-            break;
-        default:
-            ystr("splith");
-            break;
+    if (WANT(DF_LAST_SPLIT_LAYOUT)) {
+        ystr("last_split_layout");
+        switch (con->layout) {
+            case L_SPLITV:
+                ystr("splitv");
+                break;
+            default:
+                ystr("splith");
+                break;
+        }
     }
 
-    ystr("border");
-    switch (con->border_style) {
-        case BS_NORMAL:
-            ystr("normal");
-            break;
-        case BS_NONE:
-            ystr("none");
-            break;
-        case BS_PIXEL:
-            ystr("pixel");
-            break;
+    if (WANT(DF_BORDER)) {
+        ystr("border");
+        switch (con->border_style) {
+            case BS_NORMAL:
+                ystr("normal");
+                break;
+            case BS_NONE:
+                ystr("none");
+                break;
+            case BS_PIXEL:
+                ystr("pixel");
+                break;
+        }
     }
 
-    ystr("current_border_width");
-    y(integer, con->current_border_width);
+    if (WANT(DF_CURRENT_BORDER_WIDTH)) {
+        ystr("current_border_width");
+        y(integer, con->current_border_width);
+    }
 
-    dump_rect(gen, "rect", con->rect);
-    dump_rect(gen, "deco_rect", con->deco_rect);
-    dump_rect(gen, "window_rect", con->window_rect);
-    dump_rect(gen, "geometry", con->geometry);
+    if (WANT(DF_RECT))
+        dump_rect(gen, "rect", con->rect);
+    if (WANT(DF_DECO_RECT))
+        dump_rect(gen, "deco_rect", con->deco_rect);
+    if (WANT(DF_WINDOW_RECT))
+        dump_rect(gen, "window_rect", con->window_rect);
+    if (WANT(DF_GEOMETRY))
+        dump_rect(gen, "geometry", con->cold->geometry);
 
-    ystr("name");
-    if (con->window && con->window->name)
-        ystr(i3string_as_utf8(con->window->name));
-    else if (con->name != NULL)
-        ystr(con->name);
-    else
-        y(null);
+    if (WANT(DF_NAME)) {
+        ystr("name");
+        if (con->window && con->window->name)
+            ystr(i3string_as_utf8(con->window->name));
+        else if (con->name != NULL)
+            ystr(con->name);
+        else
+            y(null);
+    }
 
-    if (con->title_format != NULL) {
+    if (WANT(DF_TITLE_FORMAT) && con->cold->title_format != NULL) {
         ystr("title_format");
-        ystr(con->title_format);
+        ystr(con->cold->title_format);
     }
 
-    ystr("window_icon_padding");
-    y(integer, con->window_icon_padding);
+    if (WANT(DF_WINDOW_ICON_PADDING)) {
+        ystr("window_icon_padding");
+        y(integer, con->cold->window_icon_padding);
+    }
 
-    if (con->type == CT_WORKSPACE) {
+    if (WANT(DF_NUM) && con->type == CT_WORKSPACE) {
         ystr("num");
         y(integer, con->num);
     }
 
-    ystr("window");
-    if (con->window)
-        y(integer, con->window->id);
-    else
-        y(null);
+    if (WANT(DF_WINDOW)) {
+        ystr("window");
+        if (con->window)
+            y(integer, con->window->id);
+        else
+            y(null);
+    }
 
-    ystr("window_type");
-    if (con->window) {
-        if (con->window->window_type == A__NET_WM_WINDOW_TYPE_NORMAL) {
-            ystr("normal");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DOCK) {
-            ystr("dock");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DIALOG) {
-            ystr("dialog");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_UTILITY) {
-            ystr("utility");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_TOOLBAR) {
-            ystr("toolbar");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_SPLASH) {
-            ystr("splash");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_MENU) {
-            ystr("menu");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DROPDOWN_MENU) {
-            ystr("dropdown_menu");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_POPUP_MENU) {
-            ystr("popup_menu");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_TOOLTIP) {
-            ystr("tooltip");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_NOTIFICATION) {
-            ystr("notification");
-        } else {
-            ystr("unknown");
-        }
-    } else
-        y(null);
+    if (WANT(DF_WINDOW_TYPE)) {
+        ystr("window_type");
+        if (con->window) {
+            if (con->window->window_type == A__NET_WM_WINDOW_TYPE_NORMAL) {
+                ystr("normal");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DOCK) {
+                ystr("dock");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DIALOG) {
+                ystr("dialog");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_UTILITY) {
+                ystr("utility");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_TOOLBAR) {
+                ystr("toolbar");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_SPLASH) {
+                ystr("splash");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_MENU) {
+                ystr("menu");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DROPDOWN_MENU) {
+                ystr("dropdown_menu");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_POPUP_MENU) {
+                ystr("popup_menu");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_TOOLTIP) {
+                ystr("tooltip");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_NOTIFICATION) {
+                ystr("notification");
+            } else {
+                ystr("unknown");
+            }
+        } else
+            y(null);
+    }
 
-    if (con->window && !inplace_restart) {
+    if (WANT(DF_WINDOW_PROPERTIES) && con->window && !inplace_restart) {
         /* Window properties are useless to preserve when restarting because
          * they will be queried again anyway. However, for i3-save-tree(1),
          * they are very useful and save i3-save-tree dealing with X11. */
@@ -576,67 +912,78 @@ void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
         y(map_close);
     }
 
-    ystr("nodes");
-    y(array_open);
     Con *node;
-    if (con->type != CT_DOCKAREA || !inplace_restart) {
-        TAILQ_FOREACH (node, &(con->nodes_head), nodes) {
-            dump_node(gen, node, inplace_restart);
+    if (depth != 0) {
+        ystr("nodes");
+        y(array_open);
+        if (con->type != CT_DOCKAREA || !inplace_restart) {
+            TAILQ_FOREACH (node, &(con->nodes_head), nodes) {
+                dump_node_depth(gen, node, options, depth - 1);
+            }
         }
-    }
-    y(array_close);
+        y(array_close);
 
-    ystr("floating_nodes");
-    y(array_open);
-    TAILQ_FOREACH (node, &(con->floating_head), floating_windows) {
-        dump_node(gen, node, inplace_restart);
+        ystr("floating_nodes");
+        y(array_open);
+        TAILQ_FOREACH (node, &(con->floating_head), floating_windows) {
+            dump_node_depth(gen, node, options, depth - 1);
+        }
+        y(array_close);
     }
-    y(array_close);
 
-    ystr("focus");
-    y(array_open);
-    TAILQ_FOREACH (node, &(con->focus_head), focused) {
-        y(integer, (uintptr_t)node);
+    if (WANT(DF_FOCUS)) {
+        ystr("focus");
+        y(array_open);
+        TAILQ_FOREACH (node, &(con->focus_head), focused) {
+            y(integer, node->id);
+        }
+        y(array_close);
     }
-    y(array_close);
-
-    ystr("fullscreen_mode");
-    y(integer, con->fullscreen_mode);
 
-    ystr("sticky");
-    y(bool, con->sticky);
+    if (WANT(DF_FULLSCREEN_MODE)) {
+        ystr("fullscreen_mode");
+        y(integer, con->fullscreen_mode);
+    }
 
-    ystr("floating");
-    switch (con->floating) {
-        case FLOATING_AUTO_OFF:
-            ystr("auto_off");
-            break;
-        case FLOATING_AUTO_ON:
-            ystr("auto_on");
-            break;
-        case FLOATING_USER_OFF:
-            ystr("user_off");
-            break;
-        case FLOATING_USER_ON:
-            ystr("user_on");
-            break;
+    if (WANT(DF_STICKY)) {
+        ystr("sticky");
+        y(bool, con->sticky);
     }
 
-    ystr("swallows");
-    y(array_open);
-    Match *match;
-    TAILQ_FOREACH (match, &(con->swallow_head), matches) {
-        /* We will generate a new restart_mode match specification after this
-         * loop, so skip this one. */
-        if (match->restart_mode)
-            continue;
-        y(map_open);
-        if (match->dock != M_DONTCHECK) {
-            ystr("dock");
-            y(integer, match->dock);
-            ystr("insert_where");
-            y(integer, match->insert_where);
+    if (WANT(DF_FLOATING)) {
+        ystr("floating");
+        switch (con->floating) {
+            case FLOATING_AUTO_OFF:
+                ystr("auto_off");
+                break;
+            case FLOATING_AUTO_ON:
+                ystr("auto_on");
+                break;
+            case FLOATING_USER_OFF:
+                ystr("user_off");
+                break;
+            case FLOATING_USER_ON:
+                ystr("user_on");
+                break;
         }
+    }
+
+    if (WANT(DF_SWALLOWS)) {
+        ystr("swallows");
+        y(array_open);
+        Match *match;
+        TAILQ_FOREACH (match, &(con->cold->swallow_head), matches) {
+            /* We will generate a new restart_mode match specification after this
+             * loop, so skip this one. */
+            if (match->restart_mode)
+                continue;
+            y(map_open);
+            if (match->dock != M_DONTCHECK) {
+                ystr("dock");
+                y(integer, match->dock);
+                ystr("insert_where");
+                y(integer, match->insert_where);
+            }
 
 #define DUMP_REGEX(re_name)                \
     do {                                   \
@@ -646,34 +993,35 @@ void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
         }                                  \
     } while (0)
 
-        DUMP_REGEX(class);
-        DUMP_REGEX(instance);
-        DUMP_REGEX(window_role);
-        DUMP_REGEX(title);
-        DUMP_REGEX(machine);
+            DUMP_REGEX(class);
+            DUMP_REGEX(instance);
+            DUMP_REGEX(window_role);
+            DUMP_REGEX(title);
+            DUMP_REGEX(machine);
 
 #undef DUMP_REGEX
-        y(map_close);
-    }
-
-    if (inplace_restart) {
-        if (con->window != NULL) {
-            y(map_open);
-            ystr("id");
-            y(integer, con->window->id);
-            ystr("restart_mode");
-            y(bool, true);
             y(map_close);
         }
+
+        if (inplace_restart) {
+            if (con->window != NULL) {
+                y(map_open);
+                ystr("id");
+                y(integer, con->window->id);
+                ystr("restart_mode");
+                y(bool, true);
+                y(map_close);
+            }
+        }
+        y(array_close);
     }
-    y(array_close);
 
-    if (inplace_restart && con->window != NULL) {
+    if (WANT(DF_DEPTH) && inplace_restart && con->window != NULL) {
         ystr("depth");
         y(integer, con->depth);
     }
 
-    if (inplace_restart && con->type == CT_ROOT && previous_workspace_name) {
+    if (WANT(DF_PREVIOUS_WORKSPACE_NAME) && inplace_restart && con->type == CT_ROOT && previous_workspace_name) {
         ystr("previous_workspace_name");
         ystr(previous_workspace_name);
     }
@@ -681,6 +1029,21 @@ void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
     y(map_close);
 }
 
+void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
+    const dump_options_t options = {inplace_restart, DUMP_FIELDS_ALL};
+    dump_node_depth(gen, con, &options, -1);
+}
+
+/*
+ * Like dump_node(), but without the "nodes" and "floating_nodes" of the
+ * container.
+ *
+ */
+void dump_node_shallow(yajl_gen gen, struct Con *con) {
+    const dump_options_t options = {false, DUMP_FIELDS_ALL};
+    dump_node_depth(gen, con, &options, 0);
+}
+
 static void dump_bar_bindings(yajl_gen gen, Barconfig *config) {
     if (TAILQ_EMPTY(&(config->bar_bindings)))
         return;
@@ -858,12 +1221,158 @@ static void dump_bar_config(yajl_gen gen, Barconfig *config) {
 #undef YSTR_IF_SET
 }
 
+/* The optional payload of a GET_TREE request. */
+struct tree_request_state {
+    char *last_key;
+    long long con_id;
+    char *workspace;
+    char *output;
+    long long depth;
+    uint64_t fields;
+    /* Set to the reason if the request cannot be answered. */
+    const char *error;
+};
+
+static int _tree_json_key(void *extra, const unsigned char *val, size_t len) {
+    struct tree_request_state *state = extra;
+    FREE(state->last_key);
+    state->last_key = scalloc(len + 1, 1);
+    memcpy(state->last_key, val, len);
+    return 1;
+}
+
+static int _tree_json_int(void *extra, long long val) {
+    struct tree_request_state *state = extra;
+    if (state->last_key == NULL)
+        return 1;
+    if (strcasecmp(state->last_key, "con_id") == 0) {
+        state->con_id = val;
+    } else if (strcasecmp(state->last_key, "depth") == 0) {
+        state->depth = val;
+    }
+    return 1;
+}
+
+static int _tree_json_string(void *extra, const unsigned char *val, size_t len) {
+    struct tree_request_state *state = extra;
+    if (state->last_key == NULL)
+        return 1;
+    if (strcasecmp(state->last_key, "workspace") == 0) {
+        FREE(state->workspace);
+        state->workspace = sstrndup((const char *)val, len);
+    } else if (strcasecmp(state->last_key, "output") == 0) {
+        FREE(state->output);
+        state->output = sstrndup((const char *)val, len);
+    } else if (strcasecmp(state->last_key, "fields") == 0) {
+        for (size_t i = 0; i < NUM_DUMP_FIELDS; i++) {
+            if (strlen(dump_field_names[i]) == len &&
+                strncmp(dump_field_names[i], (const char *)val, len) == 0) {
+                state->fields |= ((uint64_t)1 << i);
+                return 1;
+            }
+        }
+        ELOG("Unknown field \"%.*s\" in GET_TREE request\n", (int)len, val);
+        state->error = "Unknown field";
+    }
+    return 1;
+}
+
+static int _tree_json_start_array(void *extra) {
+    struct tree_request_state *state = extra;
+    /* Only the listed fields are dumped. */
+    if (state->last_key != NULL && strcasecmp(state->last_key, "fields") == 0)
+        state->fields = 0;
+    return 1;
+}
+
+/*
+ * Returns the container selected by the GET_TREE request, the root container
+ * if it does not select one, or NULL (and sets state->error) if the selected
+ * container does not exist.
+ *
+ */
+static Con *tree_request_root(struct tree_request_state *state) {
+    if ((state->con_id != 0) + (state->workspace != NULL) + (state->output != NULL) > 1) {
+        state->error = "Only one of con_id, workspace and output can be given";
+        return NULL;
+    }
+
+    Con *con = croot;
+    if (state->con_id != 0) {
+        con = con_by_con_id(state->con_id);
+    } else if (state->workspace != NULL) {
+        con = get_existing_workspace_by_name(state->workspace);
+    } else if (state->output != NULL) {
+        Output *output = get_output_by_name(state->output, true);
+        con = (output != NULL ? output->con : NULL);
+    }
+    if (con == NULL)
+        state->error = "No such container";
+    return con;
+}
+
+/*
+ * Formats the reply message for a GET_TREE request and sends it to the client.
+ * The optional payload selects the root of the dumped subtree, the maximum
+ * depth and the fields of each node (see docs/ipc).
+ *
+ */
 IPC_HANDLER(tree) {
+    /* Send the pending tree event first, so that clients which apply them to
+     * this reply don't see changes twice. */
+    tree_delta_flush();
+
+    struct tree_request_state state;
+    memset(&state, '\0', sizeof(struct tree_request_state));
+    state.depth = -1;
+    state.fields = DUMP_FIELDS_ALL;
+
+    if (message_size > 0) {
+        static yajl_callbacks callbacks = {
+            .yajl_integer = _tree_json_int,
+            .yajl_string = _tree_json_string,
+            .yajl_map_key = _tree_json_key,
+            .yajl_start_array = _tree_json_start_array,
+        };
+
+        yajl_handle p = yalloc(&callbacks, (void *)&state);
+        yajl_status stat = yajl_parse(p, (const unsigned char *)message, message_size);
+        if (stat == yajl_status_ok)
+            stat = yajl_complete_parse(p);
+        if (stat != yajl_status_ok) {
+            unsigned char *err;
+            err = yajl_get_error(p, true, (const unsigned char *)message,
+                                 message_size);
+            ELOG("YAJL parse error: %s\n", err);
+            yajl_free_error(p, err);
+            state.error = "Could not parse the request";
+        }
+        yajl_free(p);
+    }
+
+    Con *root = NULL;
+    if (state.error == NULL)
+        root = tree_request_root(&state);
+
     setlocale(LC_NUMERIC, "C");
     yajl_gen gen = ygenalloc();
-    dump_node(gen, croot, false);
+    if (root == NULL) {
+        y(map_open);
+        ystr("success");
+        y(bool, false);
+        ystr("error");
+        ystr(state.error);
+        y(map_close);
+    } else {
+        const dump_options_t options = {false, state.fields};
+        dump_node_depth(gen, root, &options, (state.depth < 0 ? -1 : (int)MIN(state.depth, INT_MAX)));
+    }
     setlocale(LC_NUMERIC, "");
 
+    FREE(state.last_key);
+    FREE(state.workspace);
+    FREE(state.output);
+
     const unsigned char *payload;
     ylength length;
     y(get_buf, &payload, &length);
@@ -872,6 +1381,32 @@ IPC_HANDLER(tree) {
     y(free);
 }
 
+/*
+ * Formats the layout tree together with the current tree generation. Clients
+ * can apply all "tree" events with a higher generation to it.
+ *
+ */
+IPC_HANDLER(get_tree_snapshot) {
+    tree_delta_flush();
+
+    setlocale(LC_NUMERIC, "C");
+    yajl_gen gen = ygenalloc();
+    y(map_open);
+    ystr("generation");
+    y(integer, tree_delta_generation());
+    ystr("tree");
+    dump_node(gen, croot, false);
+    y(map_close);
+    setlocale(LC_NUMERIC, "");
+
+    const unsigned char *payload;
+    ylength length;
+    y(get_buf, &payload, &length);
+
+    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_TREE_SNAPSHOT, payload);
+    y(free);
+}
+
 /*
  * Formats the reply message for a GET_WORKSPACES request and sends it to the
  * client
@@ -893,7 +1428,7 @@ IPC_HANDLER(get_workspaces) {
             y(map_open);
 
             ystr("id");
-            y(integer, (uintptr_t)ws);
+            y(integer, ws->id);
 
             ystr("num");
             y(integer, ws->num);
@@ -1005,7 +1540,7 @@ IPC_HANDLER(get_marks) {
     Con *con;
     TAILQ_FOREACH (con, &all_cons, all_cons) {
         mark_t *mark;
-        TAILQ_FOREACH (mark, &(con->marks_head), marks) {
+        TAILQ_FOREACH (mark, &(con->cold->marks_head), marks) {
             ystr(mark->name);
         }
     }
@@ -1157,21 +1692,19 @@ static int add_subscription(void *extra, const unsigned char *s,
     ipc_client *client = extra;
 
     DLOG("should add subscription to extra %p, sub %.*s\n", client, (int)len, s);
-    int event = client->num_events;
-
-    client->num_events++;
-    client->events = srealloc(client->events, client->num_events * sizeof(char *));
-    /* We copy the string because it is not null-terminated and strndup()
-     * is missing on some BSD systems */
-    client->events[event] = scalloc(len + 1, 1);
-    memcpy(client->events[event], s, len);
+    for (size_t i = 0; i < NUM_EVENTS; i++) {
+        if (strlen(event_names[i]) != len || strncasecmp(event_names[i], (const char *)s, len) != 0)
+            continue;
 
-    DLOG("client is now subscribed to:\n");
-    for (int i = 0; i < client->num_events; i++) {
-        DLOG("event %s\n", client->events[i]);
+        if (!(client->events & (1U << i))) {
+            client->events |= (1U << i);
+            event_subscribers[i]++;
+        }
+        DLOG("client is now subscribed to event mask 0x%08x\n", client->events);
+        return 1;
     }
-    DLOG("(done)\n");
 
+    DLOG("Ignoring subscription to unknown event %.*s\n", (int)len, s);
     return 1;
 }
 
@@ -1211,14 +1744,7 @@ IPC_HANDLER(subscribe) {
         return;
     }
 
-    bool is_tick = false;
-    for (int i = 0; i < client->num_events; i++) {
-        if (strcmp(client->events[i], "tick") == 0) {
-            is_tick = true;
-            break;
-        }
-    }
-    if (!is_tick) {
+    if (!(client->events & IPC_EVENT_BIT(I3_IPC_EVENT_TICK))) {
         return;
     }
 
@@ -1269,7 +1795,7 @@ IPC_HANDLER(send_tick) {
     ylength length;
     y(get_buf, &payload, &length);
 
-    ipc_send_event("tick", I3_IPC_EVENT_TICK, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_TICK, (const char *)payload);
     y(free);
 
     const char *reply = "{\"success\":true}";
@@ -1354,9 +1880,75 @@ IPC_HANDLER(get_binding_state) {
     y(free);
 }
 
+/*
+ * Returns the allocation counters of all memory pools (see create_struct()),
+ * of the text width cache and of the frame copies done by x_push_changes().
+ *
+ */
+IPC_HANDLER(get_pool_stats) {
+    yajl_gen gen = ygenalloc();
+
+    y(map_open);
+
+    ystr("pools");
+    y(array_open);
+    for (struct pool_stats *s = pool_stats_head(); s != NULL; s = s->next) {
+        y(map_open);
+        ystr("name");
+        ystr(s->name);
+        ystr("in_use");
+        y(integer, s->in_use);
+        ystr("free");
+        y(integer, s->free);
+        ystr("allocations");
+        y(integer, s->allocations);
+        ystr("reused");
+        y(integer, s->reused);
+        ystr("slabs");
+        y(integer, s->slabs);
+        y(map_close);
+    }
+    y(array_close);
+
+    unsigned long hits, misses;
+    text_width_cache_stats(&hits, &misses);
+    ystr("text_width_cache");
+    y(map_open);
+    ystr("hits");
+    y(integer, hits);
+    ystr("misses");
+    y(integer, misses);
+    y(map_close);
+
+    x_frame_copy_stats_t copies;
+    x_frame_copy_stats(&copies);
+    ystr("frame_copies");
+    y(map_open);
+    ystr("pushes");
+    y(integer, copies.pushes);
+    ystr("regions");
+    y(integer, copies.regions);
+    ystr("bytes");
+    y(integer, copies.bytes);
+    ystr("last_regions");
+    y(integer, copies.last_regions);
+    ystr("last_bytes");
+    y(integer, copies.last_bytes);
+    y(map_close);
+
+    y(map_close);
+
+    const unsigned char *payload;
+    ylength length;
+    y(get_buf, &payload, &length);
+
+    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_POOL_STATS, payload);
+    y(free);
+}
+
 /* The index of each callback function corresponds to the numeric
  * value of the message type (see include/i3/ipc.h) */
-handler_t handlers[13] = {
+handler_t handlers[15] = {
     handle_run_command,
     handle_get_workspaces,
     handle_subscribe,
@@ -1370,49 +1962,111 @@ handler_t handlers[13] = {
     handle_send_tick,
     handle_sync,
     handle_get_binding_state,
+    handle_get_tree_snapshot,
+    handle_get_pool_stats,
 };
 
+/* Number of bytes read from a client at once (the input buffer grows beyond
+ * that when a larger message arrives). */
+#define IPC_READ_SIZE 4096
+
+/*
+ * Makes sure that the client's input buffer can hold at least size bytes.
+ *
+ */
+static void ipc_reserve_input(ipc_client *client, size_t size) {
+    if (client->input_capacity >= size)
+        return;
+    client->input_capacity = MAX(size, 2 * client->input_capacity);
+    client->input = srealloc(client->input, client->input_capacity);
+}
+
+/*
+ * Dispatches all complete messages in the client's input buffer and moves the
+ * remaining (incomplete) message to the front. Returns false if the client
+ * sent garbage and has to be disconnected.
+ *
+ */
+static bool ipc_handle_input(ipc_client *client) {
+    const size_t header_size = sizeof(i3_ipc_header_t);
+    size_t offset = 0;
+
+    while (client->input_size - offset >= header_size) {
+        i3_ipc_header_t header;
+        memcpy(&header, client->input + offset, header_size);
+        if (memcmp(header.magic, I3_IPC_MAGIC, strlen(I3_IPC_MAGIC)) != 0) {
+            ELOG("IPC: invalid magic in header, got \"%.*s\", want \"%s\"\n",
+                 (int)strlen(I3_IPC_MAGIC), header.magic, I3_IPC_MAGIC);
+            return false;
+        }
+
+        const size_t message_size = header_size + header.size;
+        if (client->input_size - offset < message_size) {
+            /* Wait for the rest of the payload, but allocate the space for it
+             * right away. */
+            if (offset == 0)
+                ipc_reserve_input(client, message_size);
+            break;
+        }
+
+        uint8_t *message = client->input + offset + header_size;
+        if (header.type >= (sizeof(handlers) / sizeof(handler_t)))
+            DLOG("Unhandled message type: %d\n", header.type);
+        else {
+            handler_t h = handlers[header.type];
+            h(client, message, 0, header.size, header.type);
+        }
+        offset += message_size;
+    }
+
+    if (offset > 0) {
+        client->input_size -= offset;
+        memmove(client->input, client->input + offset, client->input_size);
+        if (client->input_size >= header_size) {
+            i3_ipc_header_t header;
+            memcpy(&header, client->input, header_size);
+            ipc_reserve_input(client, header_size + header.size);
+        }
+    }
+    return true;
+}
+
 /*
- * Handler for activity on a client connection, receives a message from a
+ * Handler for activity on a client connection, receives messages from a
  * client.
  *
- * For now, the maximum message size is 2048. I’m not sure for what the
- * IPC interface will be used in the future, thus I’m not implementing a
- * mechanism for arbitrarily long messages, as it seems like overkill
- * at the moment.
+ * Reads whatever is available without blocking and dispatches all messages
+ * which are complete by now. A partial message stays in the client's input
+ * buffer until the rest of it arrives.
  *
  */
 static void ipc_receive_message(EV_P_ struct ev_io *w, int revents) {
-    uint32_t message_type;
-    uint32_t message_length;
-    uint8_t *message = NULL;
     ipc_client *client = (ipc_client *)w->data;
     assert(client->fd == w->fd);
 
-    int ret = ipc_recv_message(w->fd, &message_type, &message_length, &message);
-    /* EOF or other error */
-    if (ret < 0) {
-        /* Was this a spurious read? See ev(3) */
-        if (ret == -1 && errno == EAGAIN) {
-            FREE(message);
-            return;
+    ipc_reserve_input(client, client->input_size + IPC_READ_SIZE);
+    const ssize_t n = read(w->fd, client->input + client->input_size,
+                           client->input_capacity - client->input_size);
+    if (n == -1 && (errno == EAGAIN || errno == EINTR)) {
+        /* Spurious read, see ev(3) */
+        return;
+    }
+
+    if (n <= 0) {
+        if (n == 0 && client->input_size > 0) {
+            ELOG("IPC: unexpected EOF with %zu bytes of an incomplete message\n", client->input_size);
         }
 
-        /* If not, there was some kind of error. We don’t bother and close the
+        /* EOF or some kind of error. We don’t bother and close the
          * connection. Delete the client from the list of clients. */
         free_ipc_client(client, -1);
-        FREE(message);
         return;
     }
 
-    if (message_type >= (sizeof(handlers) / sizeof(handler_t)))
-        DLOG("Unhandled message type: %d\n", message_type);
-    else {
-        handler_t h = handlers[message_type];
-        h(client, message, 0, message_length, message_type);
+    client->input_size += (size_t)n;
+    if (!ipc_handle_input(client)) {
+        free_ipc_client(client, -1);
     }
-
-    FREE(message);
 }
 
 static void ipc_client_timeout(EV_P_ ev_timer *w, int revents) {
@@ -1508,6 +2162,7 @@ ipc_client *ipc_new_client_on_fd(EV_P_ int fd) {
 
     ipc_client *client = scalloc(1, sizeof(ipc_client));
     client->fd = fd;
+    TAILQ_INIT(&(client->pending));
 
     client->read_callback = scalloc(1, sizeof(struct ev_io));
     client->read_callback->data = client;
@@ -1561,13 +2216,17 @@ yajl_gen ipc_marshal_workspace_event(const char *change, Con *current, Con *old)
  * previously focused workspace in "old".
  */
 void ipc_send_workspace_event(const char *change, Con *current, Con *old) {
+    if (!ipc_has_subscribers(I3_IPC_EVENT_WORKSPACE)) {
+        return;
+    }
+
     yajl_gen gen = ipc_marshal_workspace_event(change, current, old);
 
     const unsigned char *payload;
     ylength length;
     y(get_buf, &payload, &length);
 
-    ipc_send_event("workspace", I3_IPC_EVENT_WORKSPACE, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_WORKSPACE, (const char *)payload);
 
     y(free);
 }
@@ -1577,6 +2236,10 @@ void ipc_send_workspace_event(const char *change, Con *current, Con *old) {
  * also the window container, in "container".
  */
 void ipc_send_window_event(const char *property, Con *con) {
+    if (!ipc_has_subscribers(I3_IPC_EVENT_WINDOW)) {
+        return;
+    }
+
     DLOG("Issue IPC window %s event (con = %p, window = 0x%08x)\n",
          property, con, (con->window ? con->window->id : XCB_WINDOW_NONE));
 
@@ -1597,7 +2260,7 @@ void ipc_send_window_event(const char *property, Con *con) {
     ylength length;
     y(get_buf, &payload, &length);
 
-    ipc_send_event("window", I3_IPC_EVENT_WINDOW, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_WINDOW, (const char *)payload);
     y(free);
     setlocale(LC_NUMERIC, "");
 }
@@ -1606,6 +2269,10 @@ void ipc_send_window_event(const char *property, Con *con) {
  * For the barconfig update events, we send the serialized barconfig.
  */
 void ipc_send_barconfig_update_event(Barconfig *barconfig) {
+    if (!ipc_has_subscribers(I3_IPC_EVENT_BARCONFIG_UPDATE)) {
+        return;
+    }
+
     DLOG("Issue barconfig_update event for id = %s\n", barconfig->id);
     setlocale(LC_NUMERIC, "C");
     yajl_gen gen = ygenalloc();
@@ -1616,7 +2283,7 @@ void ipc_send_barconfig_update_event(Barconfig *barconfig) {
     ylength length;
     y(get_buf, &payload, &length);
 
-    ipc_send_event("barconfig_update", I3_IPC_EVENT_BARCONFIG_UPDATE, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_BARCONFIG_UPDATE, (const char *)payload);
     y(free);
     setlocale(LC_NUMERIC, "");
 }
@@ -1625,6 +2292,10 @@ void ipc_send_barconfig_update_event(Barconfig *barconfig) {
  * For the binding events, we send the serialized binding struct.
  */
 void ipc_send_binding_event(const char *event_type, Binding *bind) {
+    if (!ipc_has_subscribers(I3_IPC_EVENT_BINDING)) {
+        return;
+    }
+
     DLOG("Issue IPC binding %s event (sym = %s, code = %d)\n", event_type, bind->symbol, bind->keycode);
 
     setlocale(LC_NUMERIC, "C");
@@ -1645,7 +2316,7 @@ void ipc_send_binding_event(const char *event_type, Binding *bind) {
     ylength length;
     y(get_buf, &payload, &length);
 
-    ipc_send_event("binding", I3_IPC_EVENT_BINDING, (const char *)payload);
+    ipc_send_event(I3_IPC_EVENT_BINDING, (const char *)payload);
 
     y(free);
     setlocale(LC_NUMERIC, "");
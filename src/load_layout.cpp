@@ -43,7 +43,7 @@ struct pending_marks {
 /* This list is used for reordering the focus stack after parsing the 'focus'
  * array. */
 struct focus_mapping {
-    int old_id;
+    long long old_id;
     TAILQ_ENTRY(focus_mapping) focus_mappings;
 };
 
@@ -54,10 +54,10 @@ static int json_start_map(void *ctx) {
     LOG("start of map, last_key = %s\n", last_key);
     if (parsing_swallows) {
         LOG("creating new swallow\n");
-        current_swallow = smalloc(sizeof(Match));
+        current_swallow = create_struct<Match>();
         match_init(current_swallow);
         current_swallow->dock = M_DONTCHECK;
-        TAILQ_INSERT_TAIL(&(json_node->swallow_head), current_swallow, matches);
+        TAILQ_INSERT_TAIL(&(json_node->cold->swallow_head), current_swallow, matches);
         swallow_is_empty = true;
     } else {
         if (!parsing_rect && !parsing_deco_rect && !parsing_window_rect && !parsing_geometry) {
@@ -93,13 +93,13 @@ static int json_end_map(void *ctx) {
 
         /* Sanity check: swallow criteria don’t make any sense on a split
          * container. */
-        if (con_is_split(json_node) > 0 && !TAILQ_EMPTY(&(json_node->swallow_head))) {
+        if (con_is_split(json_node) > 0 && !TAILQ_EMPTY(&(json_node->cold->swallow_head))) {
             DLOG("sanity check: removing swallows specification from split container\n");
-            while (!TAILQ_EMPTY(&(json_node->swallow_head))) {
-                Match *match = TAILQ_FIRST(&(json_node->swallow_head));
-                TAILQ_REMOVE(&(json_node->swallow_head), match, matches);
+            while (!TAILQ_EMPTY(&(json_node->cold->swallow_head))) {
+                Match *match = TAILQ_FIRST(&(json_node->cold->swallow_head));
+                TAILQ_REMOVE(&(json_node->cold->swallow_head), match, matches);
                 match_free(match);
-                free(match);
+                destroy_struct(match);
             }
         }
 
@@ -142,9 +142,9 @@ static int json_end_map(void *ctx) {
                 DLOG("Geometry not set, combining children\n");
                 Con *child;
                 TAILQ_FOREACH (child, &(json_node->nodes_head), nodes) {
-                    DLOG("child geometry: %d x %d\n", child->geometry.width, child->geometry.height);
-                    json_node->rect.width += child->geometry.width;
-                    json_node->rect.height = max(json_node->rect.height, child->geometry.height);
+                    DLOG("child geometry: %d x %d\n", child->cold->geometry.width, child->cold->geometry.height);
+                    json_node->rect.width += child->cold->geometry.width;
+                    json_node->rect.height = max(json_node->rect.height, child->cold->geometry.height);
                 }
             }
 
@@ -215,10 +215,10 @@ static int json_end_array(void *ctx) {
         /* Clear the list of focus mappings */
         struct focus_mapping *mapping;
         TAILQ_FOREACH_REVERSE (mapping, &focus_mappings, focus_mappings_head, focus_mappings) {
-            LOG("focus (reverse) %d\n", mapping->old_id);
+            LOG("focus (reverse) %lld\n", mapping->old_id);
             Con *con;
             TAILQ_FOREACH (con, &(json_node->focus_head), focused) {
-                if (con->old_id != mapping->old_id)
+                if (con->cold->old_id != mapping->old_id)
                     continue;
                 LOG("got it! %p\n", con);
                 /* Move this entry to the top of the focus list. */
@@ -304,12 +304,12 @@ static int json_string(void *ctx, const unsigned char *val, size_t len) {
             json_node->name = scalloc(len + 1, 1);
             memcpy(json_node->name, val, len);
         } else if (strcasecmp(last_key, "title_format") == 0) {
-            json_node->title_format = scalloc(len + 1, 1);
-            memcpy(json_node->title_format, val, len);
+            json_node->cold->title_format = scalloc(len + 1, 1);
+            memcpy(json_node->cold->title_format, val, len);
         } else if (strcasecmp(last_key, "sticky_group") == 0) {
-            json_node->sticky_group = scalloc(len + 1, 1);
-            memcpy(json_node->sticky_group, val, len);
-            LOG("sticky_group of this container is %s\n", json_node->sticky_group);
+            json_node->cold->sticky_group = scalloc(len + 1, 1);
+            memcpy(json_node->cold->sticky_group, val, len);
+            LOG("sticky_group of this container is %s\n", json_node->cold->sticky_group);
         } else if (strcasecmp(last_key, "orientation") == 0) {
             /* Upgrade path from older versions of i3 (doing an inplace restart
              * to a newer version):
@@ -456,14 +456,14 @@ static int json_int(void *ctx, long long val) {
         json_node->current_border_width = val;
 
     if (strcasecmp(last_key, "window_icon_padding") == 0) {
-        json_node->window_icon_padding = val;
+        json_node->cold->window_icon_padding = val;
     }
 
     if (strcasecmp(last_key, "depth") == 0)
         json_node->depth = val;
 
     if (!parsing_swallows && strcasecmp(last_key, "id") == 0)
-        json_node->old_id = val;
+        json_node->cold->old_id = val;
 
     if (parsing_focus) {
         struct focus_mapping *focus_mapping = scalloc(1, sizeof(struct focus_mapping));
@@ -478,7 +478,7 @@ static int json_int(void *ctx, long long val) {
         else if (parsing_window_rect)
             r = &(json_node->window_rect);
         else
-            r = &(json_node->geometry);
+            r = &(json_node->cold->geometry);
         if (strcasecmp(last_key, "x") == 0)
             r->x = val;
         else if (strcasecmp(last_key, "y") == 0)
@@ -128,26 +128,36 @@ static void xcb_prepare_cb(EV_P_ ev_prepare *w, int revents) {
        sleeps. */
     xcb_generic_event_t *event;
 
-    while ((event = xcb_poll_for_event(conn)) != NULL) {
-        if (event->response_type == 0) {
-            if (event_is_ignored(event->sequence, 0))
-                DLOG("Expected X11 Error received for sequence %x\n", event->sequence);
-            else {
-                xcb_generic_error_t *error = (xcb_generic_error_t *)event;
-                DLOG("X11 Error received (probably harmless)! sequence 0x%x, error_code = %d\n",
-                     error->sequence, error->error_code);
+    /* Renders requested by the handlers (or by other watchers which ran in
+     * this iteration) happen once, after the whole batch of events has been
+     * handled. Rendering can queue new events, so we loop until both the
+     * event queue is empty and no render is pending. */
+    do {
+        while ((event = xcb_poll_for_event(conn)) != NULL) {
+            if (event->response_type == 0) {
+                if (event_is_ignored(event->sequence, 0))
+                    DLOG("Expected X11 Error received for sequence %x\n", event->sequence);
+                else {
+                    xcb_generic_error_t *error = (xcb_generic_error_t *)event;
+                    DLOG("X11 Error received (probably harmless)! sequence 0x%x, error_code = %d\n",
+                         error->sequence, error->error_code);
+                }
+                free(event);
+                continue;
             }
-            free(event);
-            continue;
-        }
 
-        /* Strip off the highest bit (set if the event is generated) */
-        int type = (event->response_type & 0x7F);
+            /* Strip off the highest bit (set if the event is generated) */
+            int type = (event->response_type & 0x7F);
 
-        handle_event(type, event);
+            handle_event(type, event);
 
-        free(event);
-    }
+            free(event);
+        }
+    } while (tree_flush_render());
+
+    /* Send the tree changes which did not need a render (e.g. marks on hidden
+     * workspaces) to IPC clients. */
+    tree_delta_flush();
 
     /* Flush all queued events to X11. */
     xcb_flush(conn);
@@ -182,6 +192,7 @@ static void i3_exit(void) {
         shm_unlink(shmlogname);
     }
     ipc_shutdown(SHUTDOWN_REASON_EXIT, -1);
+    log_pool_stats();
     unlink(config.ipc_socket_path);
     if (current_log_stream_socket_path != NULL) {
         unlink(current_log_stream_socket_path);
@@ -29,11 +29,11 @@ static xcb_window_t _match_depth(i3Window *win, Con *con) {
  *
  */
 static void _remove_matches(Con *con) {
-    while (!TAILQ_EMPTY(&(con->swallow_head))) {
-        Match *first = TAILQ_FIRST(&(con->swallow_head));
-        TAILQ_REMOVE(&(con->swallow_head), first, matches);
+    while (!TAILQ_EMPTY(&(con->cold->swallow_head))) {
+        Match *first = TAILQ_FIRST(&(con->cold->swallow_head));
+        TAILQ_REMOVE(&(con->cold->swallow_head), first, matches);
         match_free(first);
-        free(first);
+        destroy_struct(first);
     }
 }
 
@@ -362,9 +362,9 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
          * once. */
         if (match != NULL && match->insert_where != M_BELOW) {
             DLOG("Removing match %p from container %p\n", match, nc);
-            TAILQ_REMOVE(&(nc->swallow_head), match, matches);
+            TAILQ_REMOVE(&(nc->cold->swallow_head), match, matches);
             match_free(match);
-            FREE(match);
+            FREE_STRUCT(match);
         }
 
         cwindow->swallowed = true;
@@ -381,10 +381,12 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
     }
     xcb_window_t old_frame = XCB_NONE;
     if (nc->window != cwindow && nc->window != NULL) {
+        con_unindex_window(nc);
         window_free(nc->window);
         old_frame = _match_depth(cwindow, nc);
     }
     nc->window = cwindow;
+    con_invalidate_tree_representation(nc);
     x_reinit(nc);
 
     nc->border_width = geom->border_width;
@@ -525,8 +527,8 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
      * window to be useful (smaller windows are usually overlays/toolbars/…
      * which are not managed by the wm anyways). We store the original geometry
      * here because it’s used for dock clients. */
-    if (nc->geometry.width == 0)
-        nc->geometry = (Rect){geom->x, geom->y, geom->width, geom->height};
+    if (nc->cold->geometry.width == 0)
+        nc->cold->geometry = (Rect){geom->x, geom->y, geom->width, geom->height};
 
     if (motif_border_style != BS_NORMAL) {
         DLOG("MOTIF_WM_HINTS specifies decorations (border_style = %d)\n", motif_border_style);
@@ -538,7 +540,7 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
     }
 
     if (want_floating) {
-        DLOG("geometry = %d x %d\n", nc->geometry.width, nc->geometry.height);
+        DLOG("geometry = %d x %d\n", nc->cold->geometry.width, nc->cold->geometry.height);
         /* automatically set the border to the default value if a motif border
          * was not specified */
         bool automatic_border = (motif_border_style == BS_NORMAL);
@@ -672,7 +674,14 @@ void manage_window(xcb_window_t window, xcb_get_window_attributes_cookie_t cooki
         con_activate(nc);
     }
 
-    tree_render();
+    /* The old frame can only be destroyed once the new one is visible, so we
+     * need to render right away in that case. Otherwise, the render is
+     * coalesced with the other events of this batch (for example when a client
+     * maps lots of windows at once). */
+    if (old_frame != XCB_NONE)
+        tree_render();
+    else
+        tree_request_render();
 
     /* Destroy the old frame if we had to reframe the container. This needs to be done
      * after rendering in order to prevent the background from flickering in its place. */
@@ -729,6 +738,7 @@ Con *remanage_window(Con *con) {
     } else {
         _remove_matches(nc);
     }
+    con_unindex_window(nc);
     window_free(nc->window);
 
     xcb_window_t old_frame = _match_depth(con->window, nc);
@@ -51,7 +51,7 @@ bool match_is_empty(Match *match) {
             match->urgent == U_DONTCHECK &&
             match->id == XCB_NONE &&
             match->window_type == UINT32_MAX &&
-            match->con_id == NULL &&
+            match->con_id == 0 &&
             match->dock == M_NODOCK &&
             match->window_mode == WM_ANY);
 }
@@ -202,7 +202,7 @@ bool match_matches_window(Match *match, i3Window *window) {
 
         bool matched = false;
         mark_t *mark;
-        TAILQ_FOREACH (mark, &(con->marks_head), marks) {
+        TAILQ_FOREACH (mark, &(con->cold->marks_head), marks) {
             if (regex_matches(match->mark, mark->name)) {
                 matched = true;
                 break;
@@ -307,7 +307,7 @@ void match_parse_property(Match *match, const char *ctype, const char *cvalue) {
 
     if (strcmp(ctype, "con_id") == 0) {
         if (strcmp(cvalue, "__focused__") == 0) {
-            match->con_id = focused;
+            match->con_id = focused->id;
             return;
         }
 
@@ -316,8 +316,8 @@ void match_parse_property(Match *match, const char *ctype, const char *cvalue) {
             ELOG("Could not parse con id \"%s\"\n", cvalue);
             match->error = sstrdup("invalid con_id");
         } else {
-            match->con_id = (Con *)parsed;
-            DLOG("id as int = %p\n", match->con_id);
+            match->con_id = parsed;
+            DLOG("con_id = %ld\n", parsed);
         }
         return;
     }
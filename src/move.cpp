@@ -160,12 +160,15 @@ void insert_con_into(Con *con, Con *target, position_t position) {
     } else if (position == AFTER) {
         TAILQ_INSERT_AFTER(&(parent->nodes_head), target, con, nodes);
     }
+    tree_delta_attached(con);
 
     /* Pretend the con was just opened with regards to size percent values.
      * Since the con is moved to a completely different con, the old value
      * does not make sense anyways. */
     con->percent = 0.0;
     con_fix_percent(parent);
+    con_mark_dirty(con);
+    con_invalidate_tree_representation(con);
 
     CALL(old_parent, on_remove_child);
 }
@@ -187,6 +190,9 @@ static void attach_to_workspace(Con *con, Con *ws, direction_t direction) {
         TAILQ_INSERT_TAIL(&(ws->nodes_head), con, nodes);
     }
     TAILQ_INSERT_TAIL(&(ws->focus_head), con, focused);
+    con_mark_dirty(con);
+    con_invalidate_tree_representation(con);
+    tree_delta_attached(con);
 
     /* Pretend the con was just opened with regards to size percent values.
      * Since the con is moved to a completely different con, the old value
@@ -235,7 +241,7 @@ static void move_to_output_directed(Con *con, direction_t direction) {
     }
 
     /* force re-painting the indicators */
-    FREE(con->deco_render_params);
+    con->deco_render_params_valid = false;
 
     ipc_send_window_event("move", con);
     tree_flatten(croot);
@@ -320,6 +326,8 @@ void tree_move(Con *con, direction_t direction) {
                 } else {
                     TAILQ_SWAP(con, swap, &(swap->parent->nodes_head), nodes);
                 }
+                con_invalidate_tree_representation(con);
+                tree_delta_children(con->parent);
 
                 ipc_send_window_event("move", con);
                 return;
@@ -382,7 +390,7 @@ void tree_move(Con *con, direction_t direction) {
 
 end:
     /* force re-painting the indicators */
-    FREE(con->deco_render_params);
+    con->deco_render_params_valid = false;
 
     ipc_send_window_event("move", con);
     tree_flatten(croot);
@@ -350,6 +350,8 @@ void output_init_con(Output *output) {
         con->name = sstrdup(output_primary_name(output));
         con->type = CT_OUTPUT;
         con->layout = L_OUTPUT;
+        tree_delta_property(con, TREE_DELTA_NAME);
+        tree_delta_property(con, TREE_DELTA_LAYOUT);
         con_fix_percent(croot);
     }
     con->rect = output->rect;
@@ -370,11 +372,11 @@ void output_init_con(Output *output) {
     topdock->type = CT_DOCKAREA;
     topdock->layout = L_DOCKAREA;
     /* this container swallows dock clients */
-    Match *match = scalloc(1, sizeof(Match));
+    Match *match = create_struct<Match>();
     match_init(match);
     match->dock = M_DOCK_TOP;
     match->insert_where = M_BELOW;
-    TAILQ_INSERT_TAIL(&(topdock->swallow_head), match, matches);
+    TAILQ_INSERT_TAIL(&(topdock->cold->swallow_head), match, matches);
 
     FREE(topdock->name);
     topdock->name = sstrdup("topdock");
@@ -404,11 +406,11 @@ void output_init_con(Output *output) {
     bottomdock->type = CT_DOCKAREA;
     bottomdock->layout = L_DOCKAREA;
     /* this container swallows dock clients */
-    match = scalloc(1, sizeof(Match));
+    match = create_struct<Match>();
     match_init(match);
     match->dock = M_DOCK_BOTTOM;
     match->insert_where = M_BELOW;
-    TAILQ_INSERT_TAIL(&(bottomdock->swallow_head), match, matches);
+    TAILQ_INSERT_TAIL(&(bottomdock->cold->swallow_head), match, matches);
 
     FREE(bottomdock->name);
     bottomdock->name = sstrdup("bottomdock");
@@ -545,10 +547,15 @@ static void output_change_mode(xcb_connection_t *conn, Output *output) {
                 continue;
 
             workspace->layout = (output->rect.height > output->rect.width) ? L_SPLITV : L_SPLITH;
+            con_invalidate_tree_representation(workspace);
+            tree_delta_property(workspace, TREE_DELTA_LAYOUT);
             DLOG("Setting workspace [%d,%s]'s layout to %d.\n", workspace->num, workspace->name, workspace->layout);
             if ((child = TAILQ_FIRST(&(workspace->nodes_head)))) {
-                if (child->layout == L_SPLITV || child->layout == L_SPLITH)
+                if (child->layout == L_SPLITV || child->layout == L_SPLITH) {
                     child->layout = workspace->layout;
+                    con_invalidate_tree_representation(child);
+                    tree_delta_property(child, TREE_DELTA_LAYOUT);
+                }
                 DLOG("Setting child [%d,%s]'s layout to %d.\n", child->num, child->name, child->layout);
             }
         }
@@ -321,7 +321,7 @@ static void render_output(Con *con) {
 
         child->rect.height = 0;
         TAILQ_FOREACH (dockchild, &(child->nodes_head), nodes) {
-            child->rect.height += dockchild->geometry.height;
+            child->rect.height += dockchild->cold->geometry.height;
         }
 
         height -= child->rect.height;
@@ -444,7 +444,7 @@ static void render_con_dockarea(Con *con, Con *child, render_params *p) {
     child->rect.x = p->x;
     child->rect.y = p->y;
     child->rect.width = p->rect.width;
-    child->rect.height = child->geometry.height;
+    child->rect.height = child->cold->geometry.height;
 
     child->deco_rect.x = 0;
     child->deco_rect.y = 0;
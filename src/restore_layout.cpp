@@ -138,7 +138,7 @@ static void update_placeholder_contents(placeholder_state *state) {
 
     Match *swallows;
     int n = 0;
-    TAILQ_FOREACH (swallows, &(state->con->swallow_head), matches) {
+    TAILQ_FOREACH (swallows, &(state->con->cold->swallow_head), matches) {
         char *serialized = NULL;
 
 #define APPEND_REGEX(re_name)                                                                                                                        \
@@ -185,7 +185,7 @@ static void update_placeholder_contents(placeholder_state *state) {
 static void open_placeholder_window(Con *con) {
     if (con_is_leaf(con) &&
         (con->window == NULL || con->window->id == XCB_NONE) &&
-        !TAILQ_EMPTY(&(con->swallow_head)) &&
+        !TAILQ_EMPTY(&(con->cold->swallow_head)) &&
         con->type == CT_CON) {
         xcb_window_t placeholder = create_window(
             restore_conn,
@@ -224,11 +224,11 @@ static void open_placeholder_window(Con *con) {
         TAILQ_INSERT_TAIL(&state_head, state, state);
 
         /* create temporary id swallow to match the placeholder */
-        Match *temp_id = smalloc(sizeof(Match));
+        Match *temp_id = create_struct<Match>();
         match_init(temp_id);
         temp_id->dock = M_DONTCHECK;
         temp_id->id = placeholder;
-        TAILQ_INSERT_HEAD(&(con->swallow_head), temp_id, matches);
+        TAILQ_INSERT_HEAD(&(con->cold->swallow_head), temp_id, matches);
     }
 
     Con *child;
@@ -12,6 +12,9 @@
 void sync_respond(xcb_window_t window, uint32_t rnd) {
     DLOG("[i3 sync protocol] Sending random value %d back to X11 window 0x%08x\n", rnd, window);
 
+    /* The sync reply promises that everything i3 did before is visible. */
+    tree_flush_render();
+
     void *reply = scalloc(32, 1);
     xcb_client_message_event_t *ev = reply;
 
@@ -14,6 +14,9 @@ struct Con *focused;
 
 struct all_cons_head all_cons = TAILQ_HEAD_INITIALIZER(all_cons);
 
+/* Set by tree_request_render(), cleared by every tree_render(). */
+static bool render_requested = false;
+
 /*
  * Create the pseudo-output __i3. Output-independent workspaces such as
  * __i3_scratch will live there.
@@ -111,6 +114,7 @@ bool tree_restore(const char *path, xcb_get_geometry_reply_t *geometry) {
          * that assumption. */
         TAILQ_REMOVE(&(croot->nodes_head), __i3, nodes);
         TAILQ_INSERT_HEAD(&(croot->nodes_head), __i3, nodes);
+        tree_delta_children(croot);
     }
 
     restore_open_placeholder_windows(croot);
@@ -258,6 +262,7 @@ bool tree_close_internal(Con *con, kill_window_t kill_window, bool dont_kill_par
             add_ignore_event(cookie.sequence, 0);
         }
         ipc_send_window_event("close", con);
+        con_unindex_window(con);
         window_free(con->window);
         con->window = NULL;
     }
@@ -272,11 +277,11 @@ bool tree_close_internal(Con *con, kill_window_t kill_window, bool dont_kill_par
     con_detach(con);
 
     /* disable urgency timer, if needed */
-    if (con->urgency_timer != NULL) {
+    if (con->cold->urgency_timer != NULL) {
         DLOG("Removing urgency timer of con %p\n", con);
         workspace_update_urgent_flag(ws);
-        ev_timer_stop(main_loop, con->urgency_timer);
-        FREE(con->urgency_timer);
+        ev_timer_stop(main_loop, con->cold->urgency_timer);
+        FREE(con->cold->urgency_timer);
     }
 
     if (con->type != CT_FLOATING_CON) {
@@ -338,6 +343,7 @@ void tree_split(Con *con, orientation_t orientation) {
             }
             DLOG("Changing orientation of workspace\n");
             con->layout = (orientation == HORIZ) ? L_SPLITH : L_SPLITV;
+            tree_delta_property(con, TREE_DELTA_LAYOUT);
             return;
         } else {
             /* if there is more than one container on the workspace
@@ -358,6 +364,7 @@ void tree_split(Con *con, orientation_t orientation) {
         (parent->layout == L_SPLITH ||
          parent->layout == L_SPLITV)) {
         parent->layout = (orientation == HORIZ) ? L_SPLITH : L_SPLITV;
+        tree_delta_property(parent, TREE_DELTA_LAYOUT);
         DLOG("Just changing orientation of existing container\n");
         return;
     }
@@ -370,6 +377,7 @@ void tree_split(Con *con, orientation_t orientation) {
     TAILQ_REPLACE(&(parent->focus_head), con, new, focused);
     new->parent = parent;
     new->layout = (orientation == HORIZ) ? L_SPLITH : L_SPLITV;
+    tree_delta_attached(new);
 
     /* 3: swap 'percent' (resize factor) */
     new->percent = con->percent;
@@ -430,6 +438,10 @@ bool level_down(void) {
 static void mark_unmapped(Con *con) {
     Con *current;
 
+    /* Everything below a clean hidden workspace is unmapped already. */
+    if (con_is_clean_hidden_workspace(con))
+        return;
+
     con->mapped = false;
     TAILQ_FOREACH (current, &(con->nodes_head), nodes) {
         mark_unmapped(current);
@@ -443,15 +455,42 @@ static void mark_unmapped(Con *con) {
     }
 }
 
+/*
+ * Clears the dirty flag of every container which was pushed to X11 in this
+ * render pass. Clean hidden workspaces are skipped, so after this, every
+ * container in the tree is clean.
+ *
+ */
+static void mark_clean(Con *con) {
+    Con *current;
+
+    if (!con->dirty)
+        return;
+
+    con->dirty = false;
+    TAILQ_FOREACH (current, &(con->nodes_head), nodes) {
+        mark_clean(current);
+    }
+    TAILQ_FOREACH (current, &(con->floating_head), floating_windows) {
+        mark_clean(current);
+    }
+}
+
 /*
  * Renders the tree, that is rendering all outputs using render_con() and
  * pushing the changes to X11 using x_push_changes().
  *
+ * Hidden workspaces in which nothing changed since the last call are skipped
+ * (see con_mark_dirty()), so the cost of a render mostly depends on the
+ * visible part of the tree.
+ *
  */
 void tree_render(void) {
     if (croot == NULL)
         return;
 
+    render_requested = false;
+
     DLOG("-- BEGIN RENDERING --\n");
     /* Reset map state for all nodes in tree */
     /* TODO: a nicer method to walk all nodes would be good, maybe? */
@@ -461,9 +500,37 @@ void tree_render(void) {
     render_con(croot);
 
     x_push_changes(croot);
+    tree_delta_flush();
+
+    mark_clean(croot);
     DLOG("-- END RENDERING --\n");
 }
 
+/*
+ * Requests a tree_render() without doing it right away. All requests made
+ * while handling one batch of X11 events (or one IPC message) are coalesced
+ * into a single render, which happens in tree_flush_render().
+ *
+ */
+void tree_request_render(void) {
+    render_requested = true;
+}
+
+/*
+ * Performs the render requested with tree_request_render(), if any. Called at
+ * the end of every event loop iteration and before anything which needs the
+ * tree to be visible in X11 already (like replies to the sync protocol).
+ * Returns true if a render happened.
+ *
+ */
+bool tree_flush_render(void) {
+    if (!render_requested)
+        return false;
+
+    tree_render();
+    return true;
+}
+
 static Con *get_tree_next_workspace(Con *con, direction_t direction) {
     if (con_get_fullscreen_con(con, CF_GLOBAL)) {
         DLOG("Cannot change workspace while in global fullscreen mode.\n");
@@ -616,6 +683,7 @@ void tree_next(Con *con, direction_t direction) {
             TAILQ_REMOVE(&(parent->floating_head), last, floating_windows);
             TAILQ_INSERT_HEAD(&(parent->floating_head), last, floating_windows);
         }
+        tree_delta_children(parent);
     }
 
     workspace_show(con_get_workspace(next));
@@ -695,6 +763,8 @@ void tree_flatten(Con *con) {
         DLOG("attaching to focus list\n");
         TAILQ_INSERT_TAIL(&(parent->focus_head), current, focused);
         current->percent = con->percent;
+        con_mark_dirty(current);
+        tree_delta_attached(current);
     }
     DLOG("re-attached all\n");
 
@@ -0,0 +1,272 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved dynamic tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * tree_delta.c: Records changes to the layout tree and sends them to IPC
+ *               clients as "tree" events.
+ *
+ * Changes are collected as bits in the containers themselves and sent as one
+ * event per tree generation, which ends with the next tree_delta_flush()
+ * (after rendering or when a client asks for the tree). This way, a container
+ * which is moved around several times while handling one command is only
+ * reported once, with its final position.
+ *
+ */
+#include "all.hpp"
+#include "yajl_utils.hpp"
+
+#include <locale.h>
+
+/* Bits in con_cold.tree_delta besides the tree_delta_property_t ones. */
+#define TREE_DELTA_ADDED (1U << 30)
+#define TREE_DELTA_CHILDREN (1U << 31)
+#define TREE_DELTA_PROPERTIES (~(TREE_DELTA_ADDED | TREE_DELTA_CHILDREN))
+
+static const char *property_names[] = {
+    "name",
+    "layout",
+    "focus",
+    "urgent",
+    "marks",
+    "fullscreen_mode",
+    "floating",
+    "border",
+    "sticky",
+    "window_properties",
+};
+
+static uint64_t generation = 0;
+static bool dirty = false;
+
+/* IDs (not pointers, so that freed containers are simply not found anymore)
+ * of the containers with recorded changes. */
+static uint64_t *pending = NULL;
+static size_t pending_count = 0;
+static size_t pending_capacity = 0;
+
+/* IDs of the reported containers which have been freed. */
+static uint64_t *removed = NULL;
+static size_t removed_count = 0;
+static size_t removed_capacity = 0;
+
+static void push_id(uint64_t **ids, size_t *count, size_t *capacity, uint64_t id) {
+    if (*count == *capacity) {
+        *capacity = MAX(*capacity * 2, 64);
+        *ids = srealloc(*ids, *capacity * sizeof(uint64_t));
+    }
+    (*ids)[(*count)++] = id;
+}
+
+static void record(Con *con, uint32_t change) {
+    dirty = true;
+    if (con->cold->tree_delta == 0)
+        push_id(&pending, &pending_count, &pending_capacity, con->id);
+    con->cold->tree_delta |= change;
+}
+
+/*
+ * Records that the container was inserted into the child lists of
+ * con->parent. Containers which are attached for the first time are reported
+ * as new nodes.
+ *
+ */
+void tree_delta_attached(Con *con) {
+    tree_delta_children(con->parent);
+    if (!con->cold->tree_delta_announced)
+        record(con, TREE_DELTA_ADDED);
+}
+
+/*
+ * Records that the children of the container (nodes, floating nodes or their
+ * order) changed.
+ *
+ */
+void tree_delta_children(Con *con) {
+    if (con != NULL)
+        record(con, TREE_DELTA_CHILDREN);
+}
+
+/*
+ * Records that the given property of the container changed.
+ *
+ */
+void tree_delta_property(Con *con, tree_delta_property_t property) {
+    if (con != NULL)
+        record(con, property);
+}
+
+/*
+ * Records that the container is about to be freed.
+ *
+ */
+void tree_delta_freed(Con *con) {
+    if (!con->cold->tree_delta_announced)
+        return;
+
+    dirty = true;
+    push_id(&removed, &removed_count, &removed_capacity, con->id);
+}
+
+/*
+ * Whether the container is part of the tree which clients can see. Containers
+ * which are not attached yet are reported once they are.
+ *
+ */
+static bool is_visible_to_clients(Con *con) {
+    return (con->type == CT_ROOT || con->parent != NULL);
+}
+
+static void dump_ids(yajl_gen gen, Con *con, bool floating) {
+    Con *child;
+    y(array_open);
+    if (floating) {
+        TAILQ_FOREACH (child, &(con->floating_head), floating_windows) {
+            y(integer, child->id);
+        }
+    } else {
+        TAILQ_FOREACH (child, &(con->nodes_head), nodes) {
+            y(integer, child->id);
+        }
+    }
+    y(array_close);
+}
+
+/*
+ * Starts a new tree generation if anything changed since the last call and
+ * sends the recorded changes to the clients subscribed to the "tree" event.
+ *
+ * The event lists the changes in the order in which clients can apply them:
+ * first all new nodes (without children), then the new child lists of all
+ * containers whose children changed (this is how moves are reported), then
+ * the property changes and finally the removed nodes.
+ *
+ */
+void tree_delta_flush(void) {
+    if (!dirty)
+        return;
+    dirty = false;
+    generation++;
+
+    /* Without subscribers, we only keep track of which containers have been
+     * reported (as part of GET_TREE replies). */
+    yajl_gen gen = NULL;
+    if (ipc_has_subscribers(I3_IPC_EVENT_TREE)) {
+        setlocale(LC_NUMERIC, "C");
+        gen = ygenalloc();
+        y(map_open);
+        ystr("change");
+        ystr("delta");
+        ystr("generation");
+        y(integer, generation);
+        ystr("changes");
+        y(array_open);
+    }
+
+    /* Look up the containers once, skipping the ones which have been freed
+     * in the meantime. Containers which are not attached yet stay pending. */
+    Con **cons = smalloc(MAX(pending_count, 1) * sizeof(Con *));
+    size_t count = 0;
+    size_t deferred = 0;
+    for (size_t i = 0; i < pending_count; i++) {
+        Con *con = con_by_con_id(pending[i]);
+        if (con == NULL)
+            continue;
+        if (!is_visible_to_clients(con)) {
+            pending[deferred++] = pending[i];
+            continue;
+        }
+        cons[count++] = con;
+    }
+    pending_count = deferred;
+
+    for (size_t i = 0; i < count; i++) {
+        Con *con = cons[i];
+        if (!(con->cold->tree_delta & TREE_DELTA_ADDED))
+            continue;
+        con->cold->tree_delta_announced = true;
+        if (gen == NULL)
+            continue;
+        y(map_open);
+        ystr("type");
+        ystr("add");
+        ystr("node");
+        dump_node_shallow(gen, con);
+        y(map_close);
+    }
+
+    for (size_t i = 0; gen != NULL && i < count; i++) {
+        Con *con = cons[i];
+        if (!(con->cold->tree_delta & TREE_DELTA_CHILDREN))
+            continue;
+        y(map_open);
+        ystr("type");
+        ystr("children");
+        ystr("id");
+        y(integer, con->id);
+        ystr("nodes");
+        dump_ids(gen, con, false);
+        ystr("floating_nodes");
+        dump_ids(gen, con, true);
+        y(map_close);
+    }
+
+    for (size_t i = 0; gen != NULL && i < count; i++) {
+        Con *con = cons[i];
+        const uint32_t properties = (con->cold->tree_delta & TREE_DELTA_PROPERTIES);
+        /* New nodes were dumped with their current properties already. */
+        if (properties == 0 || (con->cold->tree_delta & TREE_DELTA_ADDED))
+            continue;
+        y(map_open);
+        ystr("type");
+        ystr("property");
+        ystr("properties");
+        y(array_open);
+        for (size_t j = 0; j < sizeof(property_names) / sizeof(property_names[0]); j++) {
+            if (properties & (1U << j))
+                ystr(property_names[j]);
+        }
+        y(array_close);
+        ystr("node");
+        dump_node_shallow(gen, con);
+        y(map_close);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        cons[i]->cold->tree_delta = 0;
+    }
+    free(cons);
+
+    for (size_t i = 0; gen != NULL && i < removed_count; i++) {
+        y(map_open);
+        ystr("type");
+        ystr("remove");
+        ystr("id");
+        y(integer, removed[i]);
+        y(map_close);
+    }
+    removed_count = 0;
+
+    if (gen == NULL)
+        return;
+
+    y(array_close);
+    y(map_close);
+
+    const unsigned char *payload;
+    ylength length;
+    y(get_buf, &payload, &length);
+    ipc_send_event(I3_IPC_EVENT_TREE, (const char *)payload);
+    y(free);
+    setlocale(LC_NUMERIC, "");
+}
+
+/*
+ * Returns the current tree generation. Call tree_delta_flush() first to
+ * include changes which have not been sent yet.
+ *
+ */
+uint64_t tree_delta_generation(void) {
+    return generation;
+}
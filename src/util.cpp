@@ -270,6 +270,22 @@ static char *store_restart_layout(void) {
     return filename;
 }
 
+/*
+ * Logs the allocation counters of all memory pools (see create_struct()) and
+ * of the text width cache.
+ *
+ */
+void log_pool_stats(void) {
+    for (struct pool_stats *s = pool_stats_head(); s != NULL; s = s->next) {
+        LOG("pool %s: %zu in use, %zu free, %zu allocations (%zu reused), %zu slabs\n",
+            s->name, s->in_use, s->free, s->allocations, s->reused, s->slabs);
+    }
+
+    unsigned long hits, misses;
+    text_width_cache_stats(&hits, &misses);
+    LOG("text width cache: %lu hits, %lu misses\n", hits, misses);
+}
+
 /*
  * Restart i3 in-place
  * appends -a to argument list to disable autostart
@@ -285,6 +301,7 @@ void i3_restart(bool forget_layout) {
 
     ipc_shutdown(SHUTDOWN_REASON_RESTART, -1);
 
+    log_pool_stats();
     LOG("restarting \"%s\"...\n", start_argv[0]);
     /* make sure -a is in the argument list or add it */
     start_argv = add_argument(start_argv, "-a", NULL, NULL);
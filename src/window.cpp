@@ -11,6 +11,13 @@
 
 #include <math.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 /*
  * Frees an i3Window and all its members.
  *
@@ -20,6 +27,7 @@ void window_free(i3Window *win) {
     FREE(win->class_instance);
     i3string_free(win->name);
     cairo_surface_destroy(win->icon);
+    cairo_surface_destroy(win->icon_scaled);
     FREE(win->ran_assignments);
     FREE(win);
 }
@@ -78,7 +86,7 @@ void window_update_name(i3Window *win, xcb_get_property_reply_t *prop) {
     free(name);
 
     Con *con = con_by_window_id(win->id);
-    if (con != NULL && con->title_format != NULL) {
+    if (con != NULL && con->cold->title_format != NULL) {
         i3String *name = con_parse_title_format(con);
         ewmh_update_visible_name(win->id, i3string_as_utf8(name));
         I3STRING_FREE(name);
@@ -118,7 +126,7 @@ void window_update_name_legacy(i3Window *win, xcb_get_property_reply_t *prop) {
     free(name);
 
     Con *con = con_by_window_id(win->id);
-    if (con != NULL && con->title_format != NULL) {
+    if (con != NULL && con->cold->title_format != NULL) {
         i3String *name = con_parse_title_format(con);
         ewmh_update_visible_name(win->id, i3string_as_utf8(name));
         I3STRING_FREE(name);
@@ -486,6 +494,84 @@ void window_update_machine(i3Window *win, xcb_get_property_reply_t *prop) {
     free(prop);
 }
 
+/*
+ * Exact floor(v / 255) for v <= 255 * 255, without a division.
+ *
+ */
+static inline uint32_t div255(uint32_t v) {
+    return (v + 1 + (v >> 8)) >> 8;
+}
+
+/*
+ * Converts len ARGB pixels to premultiplied alpha (which cairo uses), eight or
+ * four pixels at a time where AVX2 or SSE2 is available. All variants compute
+ * the same (r * a) / 255 per channel.
+ *
+ */
+static void icon_premultiply(uint32_t *dst, const uint32_t *src, uint64_t len) {
+    uint64_t i = 0;
+
+#if defined(__AVX2__)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i one = _mm256_set1_epi16(1);
+        const __m256i alpha_mask = _mm256_set1_epi32(0xff000000);
+        for (; i + 8 <= len; i += 8) {
+            const __m256i pixels = _mm256_loadu_si256((const __m256i *)(src + i));
+            /* Widen the channels to 16 bits and broadcast each pixel's alpha
+             * to all of its channels. */
+            __m256i lo = _mm256_unpacklo_epi8(pixels, zero);
+            __m256i hi = _mm256_unpackhi_epi8(pixels, zero);
+            const __m256i alpha_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, 0xff), 0xff);
+            const __m256i alpha_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, 0xff), 0xff);
+            lo = _mm256_mullo_epi16(lo, alpha_lo);
+            hi = _mm256_mullo_epi16(hi, alpha_hi);
+            /* div255() */
+            lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(lo, one), _mm256_srli_epi16(lo, 8)), 8);
+            hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(hi, one), _mm256_srli_epi16(hi, 8)), 8);
+            /* Narrow again and keep the original alpha. */
+            const __m256i result = _mm256_packus_epi16(lo, hi);
+            _mm256_storeu_si256((__m256i *)(dst + i),
+                                _mm256_or_si256(_mm256_andnot_si256(alpha_mask, result),
+                                                _mm256_and_si256(alpha_mask, pixels)));
+        }
+    }
+#endif
+
+#if defined(__SSE2__)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+        for (; i + 4 <= len; i += 4) {
+            const __m128i pixels = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+            __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+            const __m128i alpha_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xff), 0xff);
+            const __m128i alpha_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xff), 0xff);
+            lo = _mm_mullo_epi16(lo, alpha_lo);
+            hi = _mm_mullo_epi16(hi, alpha_hi);
+            lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, one), _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, one), _mm_srli_epi16(hi, 8)), 8);
+            const __m128i result = _mm_packus_epi16(lo, hi);
+            _mm_storeu_si128((__m128i *)(dst + i),
+                             _mm_or_si128(_mm_andnot_si128(alpha_mask, result),
+                                          _mm_and_si128(alpha_mask, pixels)));
+        }
+    }
+#endif
+
+    for (; i < len; i++) {
+        const uint32_t pixel = src[i];
+        const uint32_t a = (pixel >> 24) & 0xff;
+        const uint32_t r = div255(((pixel >> 16) & 0xff) * a);
+        const uint32_t g = div255(((pixel >> 8) & 0xff) * a);
+        const uint32_t b = div255(((pixel >> 0) & 0xff) * a);
+
+        dst[i] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
 void window_update_icon(i3Window *win, xcb_get_property_reply_t *prop) {
     uint32_t *data = NULL;
     uint32_t width, height;
@@ -564,25 +650,16 @@ void window_update_icon(i3Window *win, xcb_get_property_reply_t *prop) {
 
     uint32_t *icon = smalloc(len * 4);
 
-    for (uint64_t i = 0; i < len; i++) {
-        uint8_t r, g, b, a;
-        const uint32_t pixel = data[2 + i];
-        a = (pixel >> 24) & 0xff;
-        r = (pixel >> 16) & 0xff;
-        g = (pixel >> 8) & 0xff;
-        b = (pixel >> 0) & 0xff;
-
-        /* Cairo uses premultiplied alpha */
-        r = (r * a) / 0xff;
-        g = (g * a) / 0xff;
-        b = (b * a) / 0xff;
-
-        icon[i] = ((uint32_t)a << 24) | (r << 16) | (g << 8) | b;
-    }
+    /* Cairo uses premultiplied alpha */
+    icon_premultiply(icon, data + 2, len);
 
     if (win->icon != NULL) {
         cairo_surface_destroy(win->icon);
     }
+    if (win->icon_scaled != NULL) {
+        cairo_surface_destroy(win->icon_scaled);
+        win->icon_scaled = NULL;
+    }
     win->icon = cairo_image_surface_create_for_data(
         (unsigned char *)icon,
         CAIRO_FORMAT_ARGB32,
@@ -594,3 +671,43 @@ void window_update_icon(i3Window *win, xcb_get_property_reply_t *prop) {
 
     FREE(prop);
 }
+
+/*
+ * Returns the window icon scaled to fit into a square of the given size (the
+ * icon size in the decoration). The scaled icon is kept, so that the icon is
+ * only scaled again when it changes or the size does (because of a different
+ * decoration height or DPI), not on every redraw.
+ *
+ */
+cairo_surface_t *window_get_scaled_icon(i3Window *win, int size) {
+    if (win->icon == NULL || size <= 0)
+        return NULL;
+
+    if (win->icon_scaled != NULL && win->icon_scaled_size == size)
+        return win->icon_scaled;
+
+    if (win->icon_scaled != NULL)
+        cairo_surface_destroy(win->icon_scaled);
+
+    const int src_width = cairo_image_surface_get_width(win->icon);
+    const int src_height = cairo_image_surface_get_height(win->icon);
+    const double scale = MIN((double)size / src_width, (double)size / src_height);
+    const int width = MAX(1, (int)lround(src_width * scale));
+    const int height = MAX(1, (int)lround(src_height * scale));
+
+    win->icon_scaled = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    win->icon_scaled_size = size;
+
+    cairo_t *cr = cairo_create(win->icon_scaled);
+    cairo_scale(cr, scale, scale);
+    cairo_set_source_surface(cr, win->icon, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    DLOG("Scaled icon of window 0x%08x from (%d,%d) to (%d,%d)\n",
+         win->id, src_width, src_height, width, height);
+
+    return win->icon_scaled;
+}
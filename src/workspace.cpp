@@ -11,6 +11,8 @@
 #include "all.hpp"
 #include "yajl_utils.hpp"
 
+#include <ctype.h>
+
 /*
  * Stores a copy of the name of the last used workspace for the workspace
  * back-and-forth switching.
@@ -22,16 +24,164 @@ char *previous_workspace_name = NULL;
  * keybindings. */
 static char **binding_workspace_names = NULL;
 
+/* Index of all workspaces, rebuilt on the next lookup after a workspace was
+ * created, renamed, moved or closed (see workspace_invalidate_index()). Where
+ * workspaces clash (same case-folded name or same number), the first one in
+ * tree order is used, like a walk over all outputs would find it. */
+static struct {
+    bool valid;
+    int size;
+
+    /* Case-folded workspace name → workspace. The keys are stored in
+     * folded_names. */
+    str_table_t by_name;
+    char **folded_names;
+    int names_count;
+
+    /* All workspaces, sorted by number (stable, i.e. in tree order for
+     * workspaces with the same number). */
+    Con **by_num;
+    int by_num_count;
+
+    /* Workspaces on non-internal outputs used by workspace_next() and
+     * workspace_prev(): the numbered ones sorted by number (stable) and the
+     * named ones in tree order. */
+    Con *first;
+    Con **numbered;
+    int numbered_count;
+    Con **named;
+    int named_count;
+} ws_index;
+
+/*
+ * Marks the workspace index as outdated. Needs to be called whenever a
+ * workspace (or output) is added to or removed from the tree, and when a
+ * workspace is renamed.
+ *
+ */
+void workspace_invalidate_index(void) {
+    ws_index.valid = false;
+}
+
+static char *fold_name(const char *name) {
+    char *folded = sstrdup(name);
+    for (char *walk = folded; *walk != '\0'; walk++) {
+        *walk = tolower((unsigned char)*walk);
+    }
+    return folded;
+}
+
+/*
+ * Stable insertion sort by workspace number. Workspaces are mostly sorted
+ * already (each output keeps them in order), so this is close to linear.
+ *
+ */
+static void sort_by_num(Con **workspaces, int count) {
+    for (int i = 1; i < count; i++) {
+        Con *ws = workspaces[i];
+        int j = i;
+        while (j > 0 && workspaces[j - 1]->num > ws->num) {
+            workspaces[j] = workspaces[j - 1];
+            j--;
+        }
+        workspaces[j] = ws;
+    }
+}
+
+/*
+ * Returns the index of the first workspace with a number >= num in the given
+ * sorted array (or count if there is none).
+ *
+ */
+static int lower_bound_num(Con **workspaces, int count, int num) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (workspaces[mid]->num < num) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void workspace_update_index(void) {
+    if (ws_index.valid)
+        return;
+
+    str_table_free(&(ws_index.by_name));
+    for (int i = 0; i < ws_index.names_count; i++) {
+        free(ws_index.folded_names[i]);
+    }
+    ws_index.names_count = 0;
+    ws_index.by_num_count = 0;
+    ws_index.numbered_count = 0;
+    ws_index.named_count = 0;
+    ws_index.first = NULL;
+
+    int count = 0;
+    Con *output;
+    TAILQ_FOREACH (output, &(croot->nodes_head), nodes) {
+        Con *content = output_get_content(output);
+        if (content == NULL)
+            continue;
+        count += con_num_children(content);
+    }
+    if (count > ws_index.size) {
+        ws_index.folded_names = srealloc(ws_index.folded_names, sizeof(char *) * count);
+        ws_index.by_num = srealloc(ws_index.by_num, sizeof(Con *) * count);
+        ws_index.numbered = srealloc(ws_index.numbered, sizeof(Con *) * count);
+        ws_index.named = srealloc(ws_index.named, sizeof(Con *) * count);
+        ws_index.size = count;
+    }
+
+    TAILQ_FOREACH (output, &(croot->nodes_head), nodes) {
+        Con *content = output_get_content(output);
+        if (content == NULL)
+            continue;
+        const bool internal = con_is_internal(output);
+        NODES_FOREACH (content) {
+            if (child->type != CT_WORKSPACE)
+                continue;
+
+            char *folded = fold_name(child->name);
+            if (str_table_lookup(&(ws_index.by_name), folded) == NULL) {
+                str_table_insert(&(ws_index.by_name), folded, child);
+                ws_index.folded_names[ws_index.names_count++] = folded;
+            } else {
+                free(folded);
+            }
+
+            ws_index.by_num[ws_index.by_num_count++] = child;
+            if (internal)
+                continue;
+            if (ws_index.first == NULL)
+                ws_index.first = child;
+            if (child->num == -1) {
+                ws_index.named[ws_index.named_count++] = child;
+            } else {
+                ws_index.numbered[ws_index.numbered_count++] = child;
+            }
+        }
+    }
+
+    sort_by_num(ws_index.by_num, ws_index.by_num_count);
+    sort_by_num(ws_index.numbered, ws_index.numbered_count);
+    ws_index.valid = true;
+}
+
 /*
  * Returns the workspace with the given name or NULL if such a workspace does
  * not exist.
  *
  */
 Con *get_existing_workspace_by_name(const char *name) {
-    Con *output, *workspace = NULL;
-    TAILQ_FOREACH (output, &(croot->nodes_head), nodes) {
-        GREP_FIRST(workspace, output_get_content(output), !strcasecmp(child->name, name));
-    }
+    workspace_update_index();
+
+    char *folded = fold_name(name);
+    Con *workspace = str_table_lookup(&(ws_index.by_name), folded);
+    free(folded);
 
     return workspace;
 }
@@ -42,12 +192,13 @@ Con *get_existing_workspace_by_name(const char *name) {
  *
  */
 Con *get_existing_workspace_by_num(int num) {
-    Con *output, *workspace = NULL;
-    TAILQ_FOREACH (output, &(croot->nodes_head), nodes) {
-        GREP_FIRST(workspace, output_get_content(output), child->num == num);
-    }
+    workspace_update_index();
 
-    return workspace;
+    int i = lower_bound_num(ws_index.by_num, ws_index.by_num_count, num);
+    if (i < ws_index.by_num_count && ws_index.by_num[i]->num == num)
+        return ws_index.by_num[i];
+
+    return NULL;
 }
 
 /*
@@ -321,9 +472,9 @@ static Con *_get_sticky(Con *con, const char *sticky_group, Con *exclude) {
 
     TAILQ_FOREACH (current, &(con->nodes_head), nodes) {
         if (current != exclude &&
-            current->sticky_group != NULL &&
+            current->cold->sticky_group != NULL &&
             current->window != NULL &&
-            strcmp(current->sticky_group, sticky_group) == 0)
+            strcmp(current->cold->sticky_group, sticky_group) == 0)
             return current;
 
         Con *recurse = _get_sticky(current, sticky_group, exclude);
@@ -333,9 +484,9 @@ static Con *_get_sticky(Con *con, const char *sticky_group, Con *exclude) {
 
     TAILQ_FOREACH (current, &(con->floating_head), floating_windows) {
         if (current != exclude &&
-            current->sticky_group != NULL &&
+            current->cold->sticky_group != NULL &&
             current->window != NULL &&
-            strcmp(current->sticky_group, sticky_group) == 0)
+            strcmp(current->cold->sticky_group, sticky_group) == 0)
             return current;
 
         Con *recurse = _get_sticky(current, sticky_group, exclude);
@@ -359,7 +510,7 @@ static void workspace_reassign_sticky(Con *con) {
 
     /* handle all children and floating windows of this node */
     TAILQ_FOREACH (current, &(con->nodes_head), nodes) {
-        if (current->sticky_group == NULL) {
+        if (current->cold->sticky_group == NULL) {
             workspace_reassign_sticky(current);
             continue;
         }
@@ -367,7 +518,7 @@ static void workspace_reassign_sticky(Con *con) {
         LOG("Ah, this one is sticky: %s / %p\n", current->name, current);
         /* 2: find a window which we can re-assign */
         Con *output = con_get_output(current);
-        Con *src = _get_sticky(output, current->sticky_group, current);
+        Con *src = _get_sticky(output, current->cold->sticky_group, current);
 
         if (src == NULL) {
             LOG("No window found for this sticky group\n");
@@ -376,10 +527,16 @@ static void workspace_reassign_sticky(Con *con) {
         }
 
         x_move_win(src, current);
+        con_unindex_window(src);
         current->window = src->window;
         current->mapped = true;
         src->window = NULL;
         src->mapped = false;
+        con_index_window(current);
+        con_invalidate_tree_representation(current);
+        con_invalidate_tree_representation(src);
+        con_mark_dirty(current);
+        con_mark_dirty(src);
 
         x_reparent_child(current, src);
 
@@ -400,8 +557,8 @@ static void workspace_reassign_sticky(Con *con) {
 static void workspace_defer_update_urgent_hint_cb(EV_P_ ev_timer *w, int revents) {
     Con *con = w->data;
 
-    ev_timer_stop(main_loop, con->urgency_timer);
-    FREE(con->urgency_timer);
+    ev_timer_stop(main_loop, con->cold->urgency_timer);
+    FREE(con->cold->urgency_timer);
 
     if (con->urgent) {
         DLOG("Resetting urgency flag of con %p by timer\n", con);
@@ -409,7 +566,7 @@ static void workspace_defer_update_urgent_hint_cb(EV_P_ ev_timer *w, int revents
         con_update_parents_urgency(con);
         workspace_update_urgent_flag(con_get_workspace(con));
         ipc_send_window_event("urgent", con);
-        tree_render();
+        tree_request_render();
     }
 }
 
@@ -480,20 +637,22 @@ void workspace_show(Con *workspace) {
          * its expiration */
         focused->urgent = true;
         workspace->urgent = true;
+        tree_delta_property(focused, TREE_DELTA_URGENT);
+        tree_delta_property(workspace, TREE_DELTA_URGENT);
 
-        if (focused->urgency_timer == NULL) {
+        if (focused->cold->urgency_timer == NULL) {
             DLOG("Deferring reset of urgency flag of con %p on newly shown workspace %p\n",
                  focused, workspace);
-            focused->urgency_timer = scalloc(1, sizeof(struct ev_timer));
+            focused->cold->urgency_timer = scalloc(1, sizeof(struct ev_timer));
             /* use a repeating timer to allow for easy resets */
-            ev_timer_init(focused->urgency_timer, workspace_defer_update_urgent_hint_cb,
+            ev_timer_init(focused->cold->urgency_timer, workspace_defer_update_urgent_hint_cb,
                           config.workspace_urgency_timer, config.workspace_urgency_timer);
-            focused->urgency_timer->data = focused;
-            ev_timer_start(main_loop, focused->urgency_timer);
+            focused->cold->urgency_timer->data = focused;
+            ev_timer_start(main_loop, focused->cold->urgency_timer);
         } else {
             DLOG("Resetting urgency timer of con %p on workspace %p\n",
                  focused, workspace);
-            ev_timer_again(main_loop, focused->urgency_timer);
+            ev_timer_again(main_loop, focused->cold->urgency_timer);
         }
     } else
         con_focus(next);
@@ -510,15 +669,19 @@ void workspace_show(Con *workspace) {
         /* check if this workspace is currently visible */
         if (!workspace_is_visible(old)) {
             LOG("Closing old workspace (%p / %s), it is empty\n", old, old->name);
-            yajl_gen gen = ipc_marshal_workspace_event("empty", old, NULL);
+            yajl_gen gen = NULL;
+            if (ipc_has_subscribers(I3_IPC_EVENT_WORKSPACE))
+                gen = ipc_marshal_workspace_event("empty", old, NULL);
             tree_close_internal(old, DONT_KILL_WINDOW, false);
 
-            const unsigned char *payload;
-            ylength length;
-            y(get_buf, &payload, &length);
-            ipc_send_event("workspace", I3_IPC_EVENT_WORKSPACE, (const char *)payload);
+            if (gen != NULL) {
+                const unsigned char *payload;
+                ylength length;
+                y(get_buf, &payload, &length);
+                ipc_send_event(I3_IPC_EVENT_WORKSPACE, (const char *)payload);
 
-            y(free);
+                y(free);
+            }
 
             /* Avoid calling output_push_sticky_windows later with a freed container. */
             if (old == old_focus) {
@@ -553,67 +716,51 @@ void workspace_show_by_name(const char *num) {
     workspace_show(workspace_get(num));
 }
 
+/*
+ * Returns the position of the given named workspace in ws_index.named or -1.
+ *
+ */
+static int named_workspace_index(Con *ws) {
+    for (int i = 0; i < ws_index.named_count; i++) {
+        if (ws_index.named[i] == ws)
+            return i;
+    }
+    return -1;
+}
+
 /*
  * Focuses the next workspace.
  *
  */
 Con *workspace_next(void) {
     Con *current = con_get_workspace(focused);
-    Con *next = NULL, *first = NULL, *first_opposite = NULL;
-    Con *output;
+    Con *next;
+
+    workspace_update_index();
 
     if (current->num == -1) {
         /* If currently a named workspace, find next named workspace. */
         if ((next = TAILQ_NEXT(current, nodes)) != NULL)
             return next;
-        bool found_current = false;
-        TAILQ_FOREACH (output, &(croot->nodes_head), nodes) {
-            /* Skip outputs starting with __, they are internal. */
-            if (con_is_internal(output))
-                continue;
-            NODES_FOREACH (output_get_content(output)) {
-                if (child->type != CT_WORKSPACE)
-                    continue;
-                if (!first)
-                    first = child;
-                if (!first_opposite || (child->num != -1 && child->num < first_opposite->num))
-                    first_opposite = child;
-                if (child == current) {
-                    found_current = true;
-                } else if (child->num == -1 && found_current) {
-                    next = child;
-                    return next;
-                }
-            }
-        }
-    } else {
-        /* If currently a numbered workspace, find next numbered workspace. */
-        TAILQ_FOREACH (output, &(croot->nodes_head), nodes) {
-            /* Skip outputs starting with __, they are internal. */
-            if (con_is_internal(output))
-                continue;
-            NODES_FOREACH (output_get_content(output)) {
-                if (child->type != CT_WORKSPACE)
-                    continue;
-                if (!first || (child->num != -1 && child->num < first->num))
-                    first = child;
-                if (!first_opposite && child->num == -1)
-                    first_opposite = child;
-                if (child->num == -1)
-                    break;
-                /* Need to check child against current and next because we are
-                 * traversing multiple lists and thus are not guaranteed the
-                 * relative order between the list of workspaces. */
-                if (current->num < child->num && (!next || child->num < next->num))
-                    next = child;
-            }
-        }
+        int i = named_workspace_index(current);
+        if (i != -1 && i + 1 < ws_index.named_count)
+            return ws_index.named[i + 1];
+
+        /* Wrap around to the numbered workspace with the lowest number,
+         * unless the very first workspace is a named one. */
+        if (ws_index.first != NULL && ws_index.first->num == -1)
+            return ws_index.first;
+        return (ws_index.numbered_count > 0 ? ws_index.numbered[0] : NULL);
     }
 
-    if (!next)
-        next = first_opposite ? first_opposite : first;
+    /* If currently a numbered workspace, find next numbered workspace. */
+    int i = lower_bound_num(ws_index.numbered, ws_index.numbered_count, current->num + 1);
+    if (i < ws_index.numbered_count)
+        return ws_index.numbered[i];
 
-    return next;
+    if (ws_index.named_count > 0)
+        return ws_index.named[0];
+    return (ws_index.numbered_count > 0 ? ws_index.numbered[0] : NULL);
 }
 
 /*
@@ -622,64 +769,34 @@ Con *workspace_next(void) {
  */
 Con *workspace_prev(void) {
     Con *current = con_get_workspace(focused);
-    Con *prev = NULL, *first_opposite = NULL, *last = NULL;
-    Con *output;
+    Con *prev;
+
+    workspace_update_index();
 
     if (current->num == -1) {
         /* If named workspace, find previous named workspace. */
         prev = TAILQ_PREV(current, nodes_head, nodes);
-        if (prev && prev->num != -1)
-            prev = NULL;
-        if (!prev) {
-            bool found_current = false;
-            TAILQ_FOREACH_REVERSE (output, &(croot->nodes_head), nodes_head, nodes) {
-                /* Skip outputs starting with __, they are internal. */
-                if (con_is_internal(output))
-                    continue;
-                NODES_FOREACH_REVERSE (output_get_content(output)) {
-                    if (child->type != CT_WORKSPACE)
-                        continue;
-                    if (!last)
-                        last = child;
-                    if (!first_opposite || (child->num != -1 && child->num > first_opposite->num))
-                        first_opposite = child;
-                    if (child == current) {
-                        found_current = true;
-                    } else if (child->num == -1 && found_current) {
-                        prev = child;
-                        return prev;
-                    }
-                }
-            }
-        }
-    } else {
-        /* If numbered workspace, find previous numbered workspace. */
-        TAILQ_FOREACH_REVERSE (output, &(croot->nodes_head), nodes_head, nodes) {
-            /* Skip outputs starting with __, they are internal. */
-            if (con_is_internal(output))
-                continue;
-            NODES_FOREACH_REVERSE (output_get_content(output)) {
-                if (child->type != CT_WORKSPACE)
-                    continue;
-                if (!last || (child->num != -1 && last->num < child->num))
-                    last = child;
-                if (!first_opposite && child->num == -1)
-                    first_opposite = child;
-                if (child->num == -1)
-                    continue;
-                /* Need to check child against current and previous because we
-                 * are traversing multiple lists and thus are not guaranteed
-                 * the relative order between the list of workspaces. */
-                if (current->num > child->num && (!prev || child->num > prev->num))
-                    prev = child;
-            }
-        }
+        if (prev && prev->num == -1)
+            return prev;
+        int i = named_workspace_index(current);
+        if (i > 0)
+            return ws_index.named[i - 1];
+
+        /* Wrap around to the numbered workspace with the highest number or
+         * to the last named workspace. */
+        if (ws_index.numbered_count > 0)
+            return ws_index.numbered[ws_index.numbered_count - 1];
+        return (ws_index.named_count > 0 ? ws_index.named[ws_index.named_count - 1] : NULL);
     }
 
-    if (!prev)
-        prev = first_opposite ? first_opposite : last;
+    /* If numbered workspace, find previous numbered workspace. */
+    int i = lower_bound_num(ws_index.numbered, ws_index.numbered_count, current->num);
+    if (i > 0)
+        return ws_index.numbered[i - 1];
 
-    return prev;
+    if (ws_index.named_count > 0)
+        return ws_index.named[ws_index.named_count - 1];
+    return (ws_index.numbered_count > 0 ? ws_index.numbered[ws_index.numbered_count - 1] : NULL);
 }
 
 /*
@@ -847,8 +964,10 @@ void workspace_update_urgent_flag(Con *ws) {
     ws->urgent = get_urgency_flag(ws);
     DLOG("Workspace urgency flag changed from %d to %d\n", old_flag, ws->urgent);
 
-    if (old_flag != ws->urgent)
+    if (old_flag != ws->urgent) {
         ipc_send_workspace_event("urgent", ws, NULL);
+        tree_delta_property(ws, TREE_DELTA_URGENT);
+    }
 }
 
 /*
@@ -879,6 +998,7 @@ void ws_force_orientation(Con *ws, orientation_t orientation) {
 
     /* 4: switch workspace layout */
     ws->layout = (orientation == HORIZ) ? L_SPLITH : L_SPLITV;
+    tree_delta_property(ws, TREE_DELTA_LAYOUT);
     DLOG("split->layout = %d, ws->layout = %d\n", split->layout, ws->layout);
 
     /* 5: attach the new split container to the workspace */
@@ -27,6 +27,82 @@ static xcb_window_t last_focused = XCB_NONE;
 /* Stores coordinates to warp mouse pointer to if set */
 static Rect *warp_to;
 
+/* Number of X11 requests sent by the current x_push_changes(), by kind. Logged
+ * at the end of each push. */
+static struct {
+    int event_masks;
+    int restacks;
+    int configures;
+    int maps;
+    int unmaps;
+} push_requests;
+
+/* Number of decorations redrawn since the last push, by the reason the cached
+ * deco_render_params could not be used. Logged at the end of each push. */
+static struct {
+    int uncached;
+    int title;
+    int marks;
+    int pixmap;
+    int colors;
+    int size;
+    int layout;
+    /* Title bars of tabbed/stacked children which were rasterized into their
+     * strip vs. only copied from it. */
+    int strips_rendered;
+    int strips_copied;
+} deco_redraws;
+
+/* Number of frame buffer regions copied to frames since the last push and
+ * their size in bytes (assuming 32 bits per pixel). Logged at the end of each
+ * push. */
+static struct {
+    int regions;
+    uint64_t bytes;
+} frame_copies;
+
+/* Cumulative frame copy counters, see x_frame_copy_stats(). */
+static x_frame_copy_stats_t frame_copy_stats;
+
+/* Frame buffer pixmaps are allocated in size classes (multiples of
+ * FRAME_BUFFER_BUCKET pixels in both dimensions), so that resizing a container
+ * usually keeps its pixmap. Released pixmaps are kept in a pool for reuse and
+ * freed after FRAME_BUFFER_IDLE seconds, or when there are more than
+ * FRAME_BUFFER_POOL_MAX of them. */
+#define FRAME_BUFFER_BUCKET 64
+#define FRAME_BUFFER_IDLE 10.0
+#define FRAME_BUFFER_POOL_MAX 16
+
+struct pooled_frame_buffer {
+    surface_t surface;
+    uint16_t depth;
+    /* The size of the pixmap (not of surface). */
+    int width;
+    int height;
+    ev_tstamp released;
+
+    TAILQ_ENTRY(pooled_frame_buffer) buffers;
+};
+
+/* Most recently released first. */
+static TAILQ_HEAD(pooled_frame_buffers_head, pooled_frame_buffer) pooled_frame_buffers =
+    TAILQ_HEAD_INITIALIZER(pooled_frame_buffers);
+static int pooled_frame_buffers_count = 0;
+static struct ev_timer *frame_buffer_trim_timer = NULL;
+
+/* Number of frame buffers created, reused from the pool and kept (because
+ * the size class did not change) since the last push. Logged at the end of
+ * each push. */
+static struct {
+    int created;
+    int reused;
+    int kept;
+} frame_buffers;
+
+/* Maximum number of damaged regions tracked per frame. More regions are merged
+ * into their bounding box. */
+#define MAX_DAMAGE_REGIONS 8
+
 /*
  * Describes the X11 state we may modify (map state, position, window stack).
  * There is one entry per container. The state represents the current situation
@@ -61,12 +137,34 @@ typedef struct con_state {
 
     bool initial;
 
+    /* Used by x_push_changes() to compute the minimal restack: the position
+     * of this state in old_state_head (counted from the bottom) and whether
+     * it needs to be restacked. */
+    int old_position;
+    bool need_restack;
+
+    /* Whether EnterNotify is disabled on this frame during the current
+     * x_push_changes(). */
+    bool mask_enter;
+
+    /* Regions of the frame buffer which were drawn to but not yet copied to
+     * the frame, see x_damage(). */
+    Rect damage[MAX_DAMAGE_REGIONS];
+    int damage_count;
+
+    /* Depth and size of the frame buffer pixmap, see
+     * x_acquire_frame_buffer(). */
+    uint16_t frame_buffer_depth;
+    int frame_buffer_width;
+    int frame_buffer_height;
+
     char *name;
 
     CIRCLEQ_ENTRY(con_state) state;
     CIRCLEQ_ENTRY(con_state) old_state;
     TAILQ_ENTRY(con_state) initial_mapping_order;
 } con_state;
+POOLED_STRUCT(con_state);
 
 CIRCLEQ_HEAD(state_head, con_state) state_head =
     CIRCLEQ_HEAD_INITIALIZER(state_head);
@@ -78,24 +176,98 @@ TAILQ_HEAD(initial_mapping_head, con_state) initial_mapping_head =
     TAILQ_HEAD_INITIALIZER(initial_mapping_head);
 
 /*
- * Returns the container state for the given frame. This function always
+ * Returns the container state for the given container. This function always
  * returns a container state (otherwise, there is a bug in the code and the
  * container state of a container for which x_con_init() was not called was
  * requested).
  *
  */
-static con_state *state_for_frame(xcb_window_t window) {
-    con_state *state;
-    CIRCLEQ_FOREACH (state, &state_head, state) {
-        if (state->id == window) {
-            return state;
+static con_state *state_for_con(Con *con) {
+    con_state *state = con->state;
+    if (state == NULL) {
+        /* TODO: better error handling? */
+        ELOG("No state found for window 0x%08x\n", con->frame.id);
+        assert(false);
+    }
+    return state;
+}
+
+/*
+ * Records that the given region (relative to the frame) of the container's
+ * frame buffer was drawn to and has to be copied to the frame by
+ * x_copy_damage().
+ *
+ */
+static void x_damage(Con *con, int x, int y, int width, int height) {
+    con_state *state = con->state;
+    if (state == NULL)
+        return;
+
+    /* Clip to the frame. */
+    const int x1 = MAX(x, 0);
+    const int y1 = MAX(y, 0);
+    const int x2 = MIN(x + width, (int)con->rect.width);
+    const int y2 = MIN(y + height, (int)con->rect.height);
+    if (x2 <= x1 || y2 <= y1)
+        return;
+    Rect region = {(uint32_t)x1, (uint32_t)y1, (uint32_t)(x2 - x1), (uint32_t)(y2 - y1)};
+
+    for (int i = 0; i < state->damage_count; i++) {
+        Rect *d = &(state->damage[i]);
+        if (region.x >= d->x && region.y >= d->y &&
+            region.x + region.width <= d->x + d->width &&
+            region.y + region.height <= d->y + d->height)
+            return;
+    }
+
+    if (state->damage_count == MAX_DAMAGE_REGIONS) {
+        /* Too fragmented, copy the bounding box instead. */
+        uint32_t bx2 = region.x + region.width;
+        uint32_t by2 = region.y + region.height;
+        for (int i = 0; i < state->damage_count; i++) {
+            Rect *d = &(state->damage[i]);
+            region.x = MIN(region.x, d->x);
+            region.y = MIN(region.y, d->y);
+            bx2 = MAX(bx2, d->x + d->width);
+            by2 = MAX(by2, d->y + d->height);
         }
+        region.width = bx2 - region.x;
+        region.height = by2 - region.y;
+        state->damage_count = 0;
     }
 
-    /* TODO: better error handling? */
-    ELOG("No state found for window 0x%08x\n", window);
-    assert(false);
-    return NULL;
+    state->damage[state->damage_count++] = region;
+}
+
+/*
+ * Copies the damaged regions of the container's frame buffer to its frame.
+ *
+ */
+static void x_copy_damage(Con *con) {
+    con_state *state = con->state;
+    if (state == NULL || state->damage_count == 0)
+        return;
+
+    if (con->frame_buffer.id != XCB_NONE) {
+        for (int i = 0; i < state->damage_count; i++) {
+            Rect *d = &(state->damage[i]);
+            draw_util_copy_surface(&(con->frame_buffer), &(con->frame),
+                                   d->x, d->y, d->x, d->y, d->width, d->height);
+            frame_copies.regions++;
+            frame_copies.bytes += (uint64_t)d->width * d->height * 4;
+        }
+    }
+    state->damage_count = 0;
+}
+
+/*
+ * Copies the given region (relative to the frame) of the container's frame
+ * buffer to its frame, for example because it was exposed.
+ *
+ */
+void x_repaint_region(Con *con, Rect region) {
+    x_damage(con, region.x, region.y, region.width, region.height);
+    x_copy_damage(con);
 }
 
 /*
@@ -137,11 +309,11 @@ void x_con_init(Con *con) {
         /* We need to create a custom colormap. */
         win_colormap = xcb_generate_id(conn);
         xcb_create_colormap(conn, XCB_COLORMAP_ALLOC_NONE, win_colormap, root, visual);
-        con->colormap = win_colormap;
+        con->cold->colormap = win_colormap;
     } else {
         /* Use the default colormap. */
         win_colormap = colormap;
-        con->colormap = XCB_NONE;
+        con->cold->colormap = XCB_NONE;
     }
 
     /* We explicitly set a background color and border color (even though we
@@ -168,6 +340,7 @@ void x_con_init(Con *con) {
     Rect dims = {-15, -15, 10, 10};
     xcb_window_t frame_id = create_window(conn, dims, con->depth, visual, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCURSOR_CURSOR_POINTER, false, mask, values);
     draw_util_surface_init(conn, &(con->frame), frame_id, get_visualtype_by_id(visual), dims.width, dims.height);
+    con_index_frame(con);
     xcb_change_property(conn,
                         XCB_PROP_MODE_REPLACE,
                         con->frame.id,
@@ -177,10 +350,11 @@ void x_con_init(Con *con) {
                         (strlen("i3-frame") + 1) * 2,
                         "i3-frame\0i3-frame\0");
 
-    struct con_state *state = scalloc(1, sizeof(struct con_state));
+    struct con_state *state = create_struct<con_state>();
     state->id = con->frame.id;
     state->mapped = false;
     state->initial = true;
+    con->state = state;
     DLOG("Adding window 0x%08x to lists\n", state->id);
     CIRCLEQ_INSERT_HEAD(&state_head, state, state);
     CIRCLEQ_INSERT_HEAD(&old_state_head, state, old_state);
@@ -197,7 +371,7 @@ void x_con_init(Con *con) {
 void x_reinit(Con *con) {
     struct con_state *state;
 
-    if ((state = state_for_frame(con->frame.id)) == NULL) {
+    if ((state = state_for_con(con)) == NULL) {
         ELOG("window state not found\n");
         return;
     }
@@ -207,6 +381,10 @@ void x_reinit(Con *con) {
     state->child_mapped = false;
     state->con = con;
     memset(&(state->window_rect), 0, sizeof(Rect));
+    con_mark_dirty(con);
+
+    /* The container just got a (new) client window. */
+    con_index_window(con);
 }
 
 /*
@@ -216,13 +394,14 @@ void x_reinit(Con *con) {
  */
 void x_reparent_child(Con *con, Con *old) {
     struct con_state *state;
-    if ((state = state_for_frame(con->frame.id)) == NULL) {
+    if ((state = state_for_con(con)) == NULL) {
         ELOG("window state for con not found\n");
         return;
     }
 
     state->need_reparent = true;
     state->old_frame = old->frame.id;
+    con_mark_dirty(con);
 }
 
 /*
@@ -232,18 +411,20 @@ void x_reparent_child(Con *con, Con *old) {
 void x_move_win(Con *src, Con *dest) {
     struct con_state *state_src, *state_dest;
 
-    if ((state_src = state_for_frame(src->frame.id)) == NULL) {
+    if ((state_src = state_for_con(src)) == NULL) {
         ELOG("window state for src not found\n");
         return;
     }
 
-    if ((state_dest = state_for_frame(dest->frame.id)) == NULL) {
+    if ((state_dest = state_for_con(dest)) == NULL) {
         ELOG("window state for dest not found\n");
         return;
     }
 
     state_dest->con = state_src->con;
     state_src->con = NULL;
+    con_mark_dirty(src);
+    con_mark_dirty(dest);
 
     if (rect_equals(state_dest->window_rect, (Rect){0, 0, 0, 0})) {
         memcpy(&(state_dest->window_rect), &(state_src->window_rect), sizeof(Rect));
@@ -251,23 +432,165 @@ void x_move_win(Con *src, Con *dest) {
     }
 }
 
+static int frame_buffer_bucket(int size) {
+    return ((size + FRAME_BUFFER_BUCKET - 1) / FRAME_BUFFER_BUCKET) * FRAME_BUFFER_BUCKET;
+}
+
+static void free_pooled_frame_buffer(struct pooled_frame_buffer *buffer) {
+    TAILQ_REMOVE(&pooled_frame_buffers, buffer, buffers);
+    pooled_frame_buffers_count--;
+    draw_util_surface_free(conn, &(buffer->surface));
+    xcb_free_pixmap(conn, buffer->surface.id);
+    free(buffer);
+}
+
+/*
+ * Frees the pooled frame buffers which have not been used for
+ * FRAME_BUFFER_IDLE seconds.
+ *
+ */
+static void frame_buffer_trim_cb(EV_P_ ev_timer *w, int revents) {
+    const ev_tstamp now = ev_now(main_loop);
+    struct pooled_frame_buffer *buffer;
+    while ((buffer = TAILQ_LAST(&pooled_frame_buffers, pooled_frame_buffers_head)) != NULL &&
+           now - buffer->released >= FRAME_BUFFER_IDLE) {
+        free_pooled_frame_buffer(buffer);
+    }
+
+    if (TAILQ_EMPTY(&pooled_frame_buffers)) {
+        ev_timer_stop(main_loop, frame_buffer_trim_timer);
+    }
+}
+
+/*
+ * Puts the frame buffer of the container into the pool.
+ *
+ */
+static void x_release_frame_buffer(Con *con) {
+    if (con->frame_buffer.id == XCB_NONE)
+        return;
+
+    con_state *state = state_for_con(con);
+    struct pooled_frame_buffer *buffer = scalloc(1, sizeof(struct pooled_frame_buffer));
+    buffer->surface = con->frame_buffer;
+    buffer->depth = state->frame_buffer_depth;
+    buffer->width = state->frame_buffer_width;
+    buffer->height = state->frame_buffer_height;
+    buffer->released = ev_now(main_loop);
+    TAILQ_INSERT_HEAD(&pooled_frame_buffers, buffer, buffers);
+    pooled_frame_buffers_count++;
+
+    if (pooled_frame_buffers_count > FRAME_BUFFER_POOL_MAX) {
+        free_pooled_frame_buffer(TAILQ_LAST(&pooled_frame_buffers, pooled_frame_buffers_head));
+    }
+
+    if (frame_buffer_trim_timer == NULL) {
+        frame_buffer_trim_timer = scalloc(1, sizeof(struct ev_timer));
+        ev_timer_init(frame_buffer_trim_timer, frame_buffer_trim_cb, FRAME_BUFFER_IDLE, FRAME_BUFFER_IDLE);
+    }
+    if (!ev_is_active(frame_buffer_trim_timer)) {
+        ev_timer_start(main_loop, frame_buffer_trim_timer);
+    }
+
+    memset(&(con->frame_buffer), 0, sizeof(surface_t));
+    con->frame_buffer.id = XCB_NONE;
+    state->damage_count = 0;
+}
+
+/*
+ * Makes sure the container has a frame buffer of the given depth which is at
+ * least width x height pixels large. The current one is kept if it is in the
+ * same size class, otherwise it is exchanged for a pooled or new one. Returns
+ * true if the contents of the frame buffer are still valid.
+ *
+ */
+static bool x_acquire_frame_buffer(Con *con, uint16_t depth, int width, int height) {
+    con_state *state = state_for_con(con);
+    const int pixmap_width = frame_buffer_bucket(width);
+    const int pixmap_height = frame_buffer_bucket(height);
+
+    if (con->frame_buffer.id != XCB_NONE &&
+        state->frame_buffer_depth == depth &&
+        state->frame_buffer_width == pixmap_width &&
+        state->frame_buffer_height == pixmap_height) {
+        const bool same_size = (con->frame_buffer.width == width && con->frame_buffer.height == height);
+        draw_util_surface_set_size(&(con->frame_buffer), width, height);
+        frame_buffers.kept++;
+        return same_size;
+    }
+
+    x_release_frame_buffer(con);
+
+    struct pooled_frame_buffer *buffer;
+    TAILQ_FOREACH (buffer, &pooled_frame_buffers, buffers) {
+        if (buffer->depth == depth && buffer->width == pixmap_width && buffer->height == pixmap_height)
+            break;
+    }
+
+    if (buffer != NULL) {
+        con->frame_buffer = buffer->surface;
+        TAILQ_REMOVE(&pooled_frame_buffers, buffer, buffers);
+        pooled_frame_buffers_count--;
+        free(buffer);
+        frame_buffers.reused++;
+    } else {
+        xcb_pixmap_t id = xcb_generate_id(conn);
+        xcb_create_pixmap(conn, depth, id, con->frame.id, pixmap_width, pixmap_height);
+        draw_util_surface_init(conn, &(con->frame_buffer), id,
+                               get_visualtype_by_id(get_visualid_by_depth(depth)), pixmap_width, pixmap_height);
+
+        /* For the graphics context, we disable GraphicsExposure events.
+         * Those will be sent when a CopyArea request cannot be fulfilled
+         * properly due to parts of the source being unmapped or otherwise
+         * unavailable. Since we always copy from pixmaps to windows, this
+         * is not a concern for us. */
+        xcb_change_gc(conn, con->frame_buffer.gc, XCB_GC_GRAPHICS_EXPOSURES, (uint32_t[]){0});
+        frame_buffers.created++;
+    }
+
+    draw_util_surface_set_size(&(con->frame_buffer), width, height);
+    state->frame_buffer_depth = depth;
+    state->frame_buffer_width = pixmap_width;
+    state->frame_buffer_height = pixmap_height;
+    return false;
+}
+
+/*
+ * Frees the title strip pixmap of the container, if any (see
+ * x_draw_title_strip()).
+ *
+ */
+static void x_free_title_strip(Con *con) {
+    surface_t *strip = &(con->cold->title_strip);
+    if (strip->id == XCB_NONE)
+        return;
+
+    draw_util_surface_free(conn, strip);
+    xcb_free_pixmap(conn, strip->id);
+    strip->id = XCB_NONE;
+    FREE(con->cold->title_strip_key);
+    con->cold->title_strip_key_len = 0;
+}
+
 static void _x_con_kill(Con *con) {
     con_state *state;
 
-    if (con->colormap != XCB_NONE) {
-        xcb_free_colormap(conn, con->colormap);
+    con_unindex_frame(con);
+
+    if (con->cold->colormap != XCB_NONE) {
+        xcb_free_colormap(conn, con->cold->colormap);
     }
 
     draw_util_surface_free(conn, &(con->frame));
-    draw_util_surface_free(conn, &(con->frame_buffer));
-    xcb_free_pixmap(conn, con->frame_buffer.id);
-    con->frame_buffer.id = XCB_NONE;
-    state = state_for_frame(con->frame.id);
+    x_release_frame_buffer(con);
+    x_free_title_strip(con);
+    state = state_for_con(con);
     CIRCLEQ_REMOVE(&state_head, state, state);
     CIRCLEQ_REMOVE(&old_state_head, state, old_state);
     TAILQ_REMOVE(&initial_mapping_head, state, initial_mapping_order);
     FREE(state->name);
-    free(state);
+    destroy_struct(state);
+    con->state = NULL;
 
     /* Invalidate focused_id to correctly focus new windows with the same ID */
     if (con->frame.id == focused_id) {
@@ -355,32 +678,27 @@ void x_window_kill(xcb_window_t window, kill_window_t kill_window) {
     free(event);
 }
 
-static void x_draw_title_border(Con *con, struct deco_render_params *p) {
-    assert(con->parent != NULL);
-
-    Rect *dr = &(con->deco_rect);
-
+static void x_draw_title_border(struct deco_render_params *p, rect_batch_t *batch, Rect *dr) {
     /* Left */
-    draw_util_rectangle(&(con->parent->frame_buffer), p->color->border,
-                        dr->x, dr->y, 1, dr->height);
+    draw_util_batch_rectangle(batch, p->color->border,
+                              dr->x, dr->y, 1, dr->height);
 
     /* Right */
-    draw_util_rectangle(&(con->parent->frame_buffer), p->color->border,
-                        dr->x + dr->width - 1, dr->y, 1, dr->height);
+    draw_util_batch_rectangle(batch, p->color->border,
+                              dr->x + dr->width - 1, dr->y, 1, dr->height);
 
     /* Top */
-    draw_util_rectangle(&(con->parent->frame_buffer), p->color->border,
-                        dr->x, dr->y, dr->width, 1);
+    draw_util_batch_rectangle(batch, p->color->border,
+                              dr->x, dr->y, dr->width, 1);
 
     /* Bottom */
-    draw_util_rectangle(&(con->parent->frame_buffer), p->color->border,
-                        dr->x, dr->y + dr->height - 1, dr->width, 1);
+    draw_util_batch_rectangle(batch, p->color->border,
+                              dr->x, dr->y + dr->height - 1, dr->width, 1);
 }
 
-static void x_draw_decoration_after_title(Con *con, struct deco_render_params *p) {
-    assert(con->parent != NULL);
-
-    Rect *dr = &(con->deco_rect);
+static void x_draw_decoration_after_title(struct deco_render_params *p, surface_t *dest, Rect *dr) {
+    rect_batch_t batch;
+    draw_util_batch_begin(&batch, dest);
 
     /* Redraw the right border to cut off any text that went past it.
      * This is necessary when the text was drawn using XCB since cutting text off
@@ -389,15 +707,16 @@ static void x_draw_decoration_after_title(Con *con, struct deco_render_params *p
         /* We actually only redraw the far right two pixels as that is the
          * distance we keep from the edge (not the entire border width).
          * Redrawing the entire border would cause text to be cut off. */
-        draw_util_rectangle(&(con->parent->frame_buffer), p->color->background,
-                            dr->x + dr->width - 2 * logical_px(1),
-                            dr->y,
-                            2 * logical_px(1),
-                            dr->height);
+        draw_util_batch_rectangle(&batch, p->color->background,
+                                  dr->x + dr->width - 2 * logical_px(1),
+                                  dr->y,
+                                  2 * logical_px(1),
+                                  dr->height);
     }
 
     /* Redraw the border. */
-    x_draw_title_border(con, p);
+    x_draw_title_border(p, &batch, dr);
+    draw_util_batch_flush(&batch);
 }
 
 /*
@@ -452,6 +771,284 @@ static size_t x_get_border_rectangles(Con *con, xcb_rectangle_t rectangles[4]) {
     return count;
 }
 
+/*
+ * Counts a decoration redraw by its reason. Only called when the decoration
+ * is actually redrawn, so the field-wise comparison is cheap in comparison.
+ *
+ */
+static void x_count_deco_redraw(Con *con, const struct deco_render_params *p) {
+    const struct deco_render_params *old = &(con->deco_render_params);
+
+    if (!con->deco_render_params_valid)
+        deco_redraws.uncached++;
+    else if (con->window != NULL && con->window->name_x_changed)
+        deco_redraws.title++;
+    else if (con->cold->mark_changed)
+        deco_redraws.marks++;
+    else if (con->parent->pixmap_recreated || con->pixmap_recreated)
+        deco_redraws.pixmap++;
+    else if (p->color != old->color ||
+             p->border_style != old->border_style ||
+             memcmp(&(p->background), &(old->background), sizeof(color_t)) != 0)
+        deco_redraws.colors++;
+    else if (memcmp(&(p->con_rect), &(old->con_rect), sizeof(struct width_height)) != 0 ||
+             memcmp(&(p->con_window_rect), &(old->con_window_rect), sizeof(struct width_height)) != 0 ||
+             memcmp(&(p->con_deco_rect), &(old->con_deco_rect), sizeof(Rect)) != 0)
+        deco_redraws.size++;
+    else
+        deco_redraws.layout++;
+}
+
+/*
+ * Returns the title to display in the decoration of the container (which may
+ * be NULL). If *owned is set, it has to be freed by the caller.
+ *
+ */
+static i3String *x_con_title(Con *con, bool *owned) {
+    struct Window *win = con->window;
+    i3String *title = NULL;
+
+    *owned = (win == NULL || con->cold->title_format != NULL);
+    if (win == NULL) {
+        if (con->cold->title_format == NULL) {
+            char *_title;
+            char *tree = con_get_tree_representation(con);
+            sasprintf(&_title, "i3: %s", tree);
+            free(tree);
+
+            title = i3string_from_utf8(_title);
+            FREE(_title);
+        } else {
+            title = con_parse_title_format(con);
+        }
+    } else {
+        title = con->cold->title_format == NULL ? win->name : con_parse_title_format(con);
+    }
+
+    return title;
+}
+
+/*
+ * Draws the title bar (background, border, icon, marks and title) of the
+ * container onto dest, at the position given by dr.
+ *
+ */
+static void x_draw_title_bar(Con *con, struct deco_render_params *p, surface_t *dest, Rect *dr,
+                             i3String *title, i3String *mark, int mark_width) {
+    rect_batch_t batch;
+    draw_util_batch_begin(&batch, dest);
+
+    /* 4: paint the bar */
+    draw_util_batch_rectangle(&batch, p->color->background,
+                              dr->x, dr->y, dr->width, dr->height);
+
+    /* 5: draw title border */
+    x_draw_title_border(p, &batch, dr);
+    draw_util_batch_flush(&batch);
+
+    /* 6: draw the icon and title */
+    int text_offset_y = (dr->height - config.font.height) / 2;
+    int text_offset_x = 0;
+
+    struct Window *win = con->window;
+
+    const int title_padding = logical_px(2);
+    const int deco_width = (int)dr->width;
+
+    /* Draw the icon */
+    if (con->cold->window_icon_padding > -1 && win && win->icon) {
+        /* icon_padding is applied horizontally only,
+         * the icon will always use all available vertical space. */
+        const int icon_padding = logical_px(1 + con->cold->window_icon_padding);
+
+        const uint16_t icon_size = dr->height - 2 * logical_px(1);
+
+        const int icon_offset_y = logical_px(1);
+
+        text_offset_x += icon_size + 2 * icon_padding;
+
+        draw_util_image(
+            window_get_scaled_icon(win, icon_size),
+            dest,
+            dr->x + icon_padding,
+            dr->y + icon_offset_y,
+            icon_size,
+            icon_size);
+    }
+
+    if (mark != NULL) {
+        int mark_offset_x = (config.title_align == ALIGN_RIGHT)
+                                ? title_padding
+                                : deco_width - mark_width - title_padding;
+
+        draw_util_text(mark, dest,
+                       p->color->text, p->color->background,
+                       dr->x + mark_offset_x,
+                       dr->y + text_offset_y, mark_width);
+
+        mark_width += title_padding;
+    } else {
+        mark_width = 0;
+    }
+
+    if (title == NULL) {
+        return;
+    }
+
+    int title_offset_x;
+    switch (config.title_align) {
+        case ALIGN_LEFT:
+            /* (pad)[text    ](pad)[mark + its pad) */
+            title_offset_x = title_padding;
+            break;
+        case ALIGN_CENTER:
+            /* (pad)[  text  ](pad)[mark + its pad)
+             * To center the text inside its allocated space, the surface
+             * between the brackets, we use the formula
+             * (surface_width - predict_text_width) / 2
+             * where surface_width = deco_width - 2 * pad - mark_width
+             * so, offset = pad + (surface_width - predict_text_width) / 2 =
+             * = … = (deco_width - mark_width - predict_text_width) / 2 */
+            title_offset_x = max(title_padding, (deco_width - mark_width - predict_text_width(title)) / 2);
+            break;
+        case ALIGN_RIGHT:
+            /* [mark + its pad](pad)[    text](pad) */
+            title_offset_x = max(title_padding + mark_width, deco_width - title_padding - predict_text_width(title));
+            break;
+    }
+
+    draw_util_text(title, dest,
+                   p->color->text, p->color->background,
+                   dr->x + text_offset_x + title_offset_x,
+                   dr->y + text_offset_y,
+                   deco_width - text_offset_x - mark_width - 2 * title_padding);
+
+    x_draw_decoration_after_title(p, dest, dr);
+}
+
+/* Scratch buffer for building title strip keys. */
+static char *strip_key = NULL;
+static size_t strip_key_len = 0;
+static size_t strip_key_size = 0;
+
+static void strip_key_append(const void *data, size_t len) {
+    if (strip_key_len + len > strip_key_size) {
+        strip_key_size = MAX(2 * strip_key_size, strip_key_len + len);
+        strip_key = srealloc(strip_key, strip_key_size);
+    }
+    memcpy(strip_key + strip_key_len, data, len);
+    strip_key_len += len;
+}
+
+/*
+ * Builds the key describing everything the title bar of the container is
+ * rendered from into strip_key.
+ *
+ */
+static void x_build_title_strip_key(Con *con, struct deco_render_params *p, i3String *title, i3String *mark) {
+    struct {
+        color_t background;
+        color_t text;
+        color_t border;
+        uint32_t width;
+        uint32_t height;
+        int title_align;
+        int icon_padding;
+        cairo_surface_t *icon;
+        int px;
+        size_t title_len;
+        bool title_markup;
+        size_t mark_len;
+        size_t font_len;
+    } header;
+    memset(&header, 0, sizeof(header));
+
+    header.background = p->color->background;
+    header.text = p->color->text;
+    header.border = p->color->border;
+    header.width = con->deco_rect.width;
+    header.height = con->deco_rect.height;
+    header.title_align = config.title_align;
+    header.icon_padding = con->cold->window_icon_padding;
+    header.icon = (con->window ? con->window->icon : NULL);
+    /* Changes with the DPI. */
+    header.px = logical_px(100);
+    header.title_len = (title ? i3string_get_num_bytes(title) : 0);
+    header.title_markup = (title ? i3string_is_markup(title) : false);
+    header.mark_len = (mark ? i3string_get_num_bytes(mark) : 0);
+    header.font_len = (config.font.pattern ? strlen(config.font.pattern) : 0);
+
+    strip_key_len = 0;
+    strip_key_append(&header, sizeof(header));
+    if (config.font.pattern)
+        strip_key_append(config.font.pattern, header.font_len);
+    if (title)
+        strip_key_append(i3string_as_utf8(title), header.title_len);
+    if (mark)
+        strip_key_append(i3string_as_utf8(mark), header.mark_len);
+}
+
+/*
+ * Draws the title bar of a child of a tabbed/stacked container. Such title bars
+ * are redrawn whenever the parent pixmap is cleared or a sibling before them
+ * changes, so each one is rasterized into a pixmap of its own (the title
+ * strip), which is then copied onto the parent server-side. The strip is only
+ * rendered again if anything it depends on changed.
+ *
+ */
+static void x_draw_title_strip(Con *con, struct deco_render_params *p, i3String *title, i3String *mark, int mark_width) {
+    surface_t *dest = &(con->parent->frame_buffer);
+    surface_t *strip = &(con->cold->title_strip);
+    Rect *dr = &(con->deco_rect);
+    if (dr->width == 0 || dr->height == 0)
+        return;
+
+    x_build_title_strip_key(con, p, title, mark);
+
+    if (strip->id != XCB_NONE &&
+        (strip->width != (int)dr->width || strip->height != (int)dr->height))
+        x_free_title_strip(con);
+
+    if (strip->id == XCB_NONE) {
+        strip->id = xcb_generate_id(conn);
+        xcb_create_pixmap(conn, root_depth, strip->id, dest->id, dr->width, dr->height);
+        draw_util_surface_init(conn, strip, strip->id,
+                               get_visualtype_by_id(get_visualid_by_depth(root_depth)), dr->width, dr->height);
+    }
+
+    if (con->cold->title_strip_key == NULL ||
+        con->cold->title_strip_key_len != strip_key_len ||
+        memcmp(con->cold->title_strip_key, strip_key, strip_key_len) != 0) {
+        Rect strip_rect = {0, 0, dr->width, dr->height};
+        x_draw_title_bar(con, p, strip, &strip_rect, title, mark, mark_width);
+
+        FREE(con->cold->title_strip_key);
+        con->cold->title_strip_key = smalloc(strip_key_len);
+        memcpy(con->cold->title_strip_key, strip_key, strip_key_len);
+        con->cold->title_strip_key_len = strip_key_len;
+        deco_redraws.strips_rendered++;
+    } else {
+        deco_redraws.strips_copied++;
+    }
+
+    CAIRO_SURFACE_FLUSH(strip->surface);
+    CAIRO_SURFACE_FLUSH(dest->surface);
+    xcb_copy_area(conn, strip->id, dest->id, dest->gc, 0, 0, dr->x, dr->y, dr->width, dr->height);
+    cairo_surface_mark_dirty_rectangle(dest->surface, dr->x, dr->y, dr->width, dr->height);
+}
+
+/*
+ * Makes the next x_draw_decoration() of the container render its title bar
+ * again instead of reusing the title strip, for example because the window
+ * icon changed.
+ *
+ */
+void x_invalidate_title_strip(Con *con) {
+    FREE(con->cold->title_strip_key);
+    con->cold->title_strip_key_len = 0;
+    con->deco_render_params_valid = false;
+}
+
 /*
  * Draws the decoration of the given container onto its parent.
  *
@@ -486,8 +1083,11 @@ void x_draw_decoration(Con *con) {
     if (leaf && con->frame_buffer.id == XCB_NONE)
         return;
 
-    /* 1: build deco_params and compare with cache */
-    struct deco_render_params *p = scalloc(1, sizeof(struct deco_render_params));
+    /* 1: build deco_params and compare with cache. The struct is zeroed
+     * (including padding) so that it can be hashed and compared bytewise. */
+    struct deco_render_params params;
+    memset(&params, 0, sizeof(struct deco_render_params));
+    struct deco_render_params *p = &params;
 
     /* find out which colors to use */
     if (con->urgent)
@@ -510,30 +1110,36 @@ void x_draw_decoration(Con *con) {
     p->con_is_leaf = con_is_leaf(con);
     p->parent_layout = con->parent->layout;
 
-    if (con->deco_render_params != NULL &&
+    if (con->deco_render_params_valid &&
         (con->window == NULL || !con->window->name_x_changed) &&
         !parent->pixmap_recreated &&
         !con->pixmap_recreated &&
-        !con->mark_changed &&
-        memcmp(p, con->deco_render_params, sizeof(struct deco_render_params)) == 0) {
-        free(p);
+        !con->cold->mark_changed &&
+        memcmp(p, &(con->deco_render_params), sizeof(struct deco_render_params)) == 0) {
         goto copy_pixmaps;
     }
 
+    x_count_deco_redraw(con, p);
+
     Con *next = con;
     while ((next = TAILQ_NEXT(next, nodes))) {
-        FREE(next->deco_render_params);
+        next->deco_render_params_valid = false;
     }
 
-    FREE(con->deco_render_params);
-    con->deco_render_params = p;
+    con->deco_render_params = params;
+    con->deco_render_params_valid = true;
 
     if (con->window != NULL && con->window->name_x_changed)
         con->window->name_x_changed = false;
 
     parent->pixmap_recreated = false;
     con->pixmap_recreated = false;
-    con->mark_changed = false;
+    con->cold->mark_changed = false;
+
+    /* The background and borders around the window are collected and drawn
+     * with one fill per color. */
+    rect_batch_t batch;
+    draw_util_batch_begin(&batch, &(con->frame_buffer));
 
     /* 2: draw the client.background, but only for the parts around the window_rect */
     if (con->window != NULL) {
@@ -541,17 +1147,24 @@ void x_draw_decoration(Con *con) {
         draw_util_clear_surface(&(con->frame_buffer), (color_t){.red = 0.0, .green = 0.0, .blue = 0.0});
 
         /* top area */
-        draw_util_rectangle(&(con->frame_buffer), config.client.background,
-                            0, 0, r->width, w->y);
+        draw_util_batch_rectangle(&batch, config.client.background,
+                                  0, 0, r->width, w->y);
         /* bottom area */
-        draw_util_rectangle(&(con->frame_buffer), config.client.background,
-                            0, w->y + w->height, r->width, r->height - (w->y + w->height));
+        draw_util_batch_rectangle(&batch, config.client.background,
+                                  0, w->y + w->height, r->width, r->height - (w->y + w->height));
         /* left area */
-        draw_util_rectangle(&(con->frame_buffer), config.client.background,
-                            0, 0, w->x, r->height);
+        draw_util_batch_rectangle(&batch, config.client.background,
+                                  0, 0, w->x, r->height);
         /* right area */
-        draw_util_rectangle(&(con->frame_buffer), config.client.background,
-                            w->x + w->width, 0, r->width - (w->x + w->width), r->height);
+        draw_util_batch_rectangle(&batch, config.client.background,
+                                  w->x + w->width, 0, r->width - (w->x + w->width), r->height);
+
+        /* Everything around the window is visible, which includes the
+         * borders drawn below. */
+        x_damage(con, 0, 0, r->width, w->y);
+        x_damage(con, 0, w->y + w->height, r->width, r->height - (w->y + w->height));
+        x_damage(con, 0, 0, w->x, r->height);
+        x_damage(con, w->x + w->width, 0, r->width - (w->x + w->width), r->height);
     }
 
     /* 3: draw a rectangle in border color around the client */
@@ -562,11 +1175,12 @@ void x_draw_decoration(Con *con) {
         xcb_rectangle_t rectangles[4];
         size_t rectangles_count = x_get_border_rectangles(con, rectangles);
         for (size_t i = 0; i < rectangles_count; i++) {
-            draw_util_rectangle(&(con->frame_buffer), p->color->child_border,
-                                rectangles[i].x,
-                                rectangles[i].y,
-                                rectangles[i].width,
-                                rectangles[i].height);
+            draw_util_batch_rectangle(&batch, p->color->child_border,
+                                      rectangles[i].x,
+                                      rectangles[i].y,
+                                      rectangles[i].width,
+                                      rectangles[i].height);
+            x_damage(con, rectangles[i].x, rectangles[i].y, rectangles[i].width, rectangles[i].height);
         }
 
         /* Highlight the side of the border at which the next window will be
@@ -578,15 +1192,19 @@ void x_draw_decoration(Con *con) {
             TAILQ_PREV(con, nodes_head, nodes) == NULL &&
             con->parent->type != CT_FLOATING_CON) {
             if (p->parent_layout == L_SPLITH) {
-                draw_util_rectangle(&(con->frame_buffer), p->color->indicator,
-                                    r->width + (br.width + br.x), br.y, -(br.width + br.x), r->height + br.height);
+                draw_util_batch_rectangle(&batch, p->color->indicator,
+                                          r->width + (br.width + br.x), br.y, -(br.width + br.x), r->height + br.height);
+                x_damage(con, r->width + (br.width + br.x), br.y, -(br.width + br.x), r->height + br.height);
             } else if (p->parent_layout == L_SPLITV) {
-                draw_util_rectangle(&(con->frame_buffer), p->color->indicator,
-                                    br.x, r->height + (br.height + br.y), r->width + br.width, -(br.height + br.y));
+                draw_util_batch_rectangle(&batch, p->color->indicator,
+                                          br.x, r->height + (br.height + br.y), r->width + br.width, -(br.height + br.y));
+                x_damage(con, br.x, r->height + (br.height + br.y), r->width + br.width, -(br.height + br.y));
             }
         }
     }
 
+    draw_util_batch_flush(&batch);
+
     /* If the parent hasn't been set up yet, skip the decoration rendering
      * for now. */
     if (parent->frame_buffer.id == XCB_NONE)
@@ -597,7 +1215,8 @@ void x_draw_decoration(Con *con) {
      * transparency. */
     if (con == TAILQ_FIRST(&(con->parent->nodes_head))) {
         draw_util_clear_surface(&(con->parent->frame_buffer), COLOR_TRANSPARENT);
-        FREE(con->parent->deco_render_params);
+        x_damage(parent, 0, 0, parent->rect.width, parent->rect.height);
+        con->parent->deco_render_params_valid = false;
     }
 
     /* if this is a borderless/1pixel window, we don’t need to render the
@@ -605,135 +1224,31 @@ void x_draw_decoration(Con *con) {
     if (p->border_style != BS_NORMAL)
         goto copy_pixmaps;
 
-    /* 4: paint the bar */
-    draw_util_rectangle(&(parent->frame_buffer), p->color->background,
-                        con->deco_rect.x, con->deco_rect.y, con->deco_rect.width, con->deco_rect.height);
+    {
+        bool title_owned;
+        i3String *title = x_con_title(con, &title_owned);
 
-    /* 5: draw title border */
-    x_draw_title_border(con, p);
-
-    /* 6: draw the icon and title */
-    int text_offset_y = (con->deco_rect.height - config.font.height) / 2;
-    int text_offset_x = 0;
-
-    struct Window *win = con->window;
-
-    const int title_padding = logical_px(2);
-    const int deco_width = (int)con->deco_rect.width;
-
-    /* Draw the icon */
-    if (con->window_icon_padding > -1 && win && win->icon) {
-        /* icon_padding is applied horizontally only,
-         * the icon will always use all available vertical space. */
-        const int icon_padding = logical_px(1 + con->window_icon_padding);
-
-        const uint16_t icon_size = con->deco_rect.height - 2 * logical_px(1);
-
-        const int icon_offset_y = logical_px(1);
-
-        text_offset_x += icon_size + 2 * icon_padding;
-
-        draw_util_image(
-            win->icon,
-            &(parent->frame_buffer),
-            con->deco_rect.x + icon_padding,
-            con->deco_rect.y + icon_offset_y,
-            icon_size,
-            icon_size);
-    }
-
-    int mark_width = 0;
-    if (config.show_marks && !TAILQ_EMPTY(&(con->marks_head))) {
-        char *formatted_mark = sstrdup("");
-        bool had_visible_mark = false;
-
-        mark_t *mark;
-        TAILQ_FOREACH (mark, &(con->marks_head), marks) {
-            if (mark->name[0] == '_')
-                continue;
-            had_visible_mark = true;
-
-            char *buf;
-            sasprintf(&buf, "%s[%s]", formatted_mark, mark->name);
-            free(formatted_mark);
-            formatted_mark = buf;
-        }
-
-        if (had_visible_mark) {
-            i3String *mark = i3string_from_utf8(formatted_mark);
-            mark_width = predict_text_width(mark);
-
-            int mark_offset_x = (config.title_align == ALIGN_RIGHT)
-                                    ? title_padding
-                                    : deco_width - mark_width - title_padding;
-
-            draw_util_text(mark, &(parent->frame_buffer),
-                           p->color->text, p->color->background,
-                           con->deco_rect.x + mark_offset_x,
-                           con->deco_rect.y + text_offset_y, mark_width);
-            I3STRING_FREE(mark);
-
-            mark_width += title_padding;
+        int mark_width = 0;
+        i3String *mark = NULL;
+        if (config.show_marks && !TAILQ_EMPTY(&(con->cold->marks_head))) {
+            mark = con_get_formatted_marks(con, &mark_width);
         }
 
-        FREE(formatted_mark);
-    }
-
-    i3String *title = NULL;
-    if (win == NULL) {
-        if (con->title_format == NULL) {
-            char *_title;
-            char *tree = con_get_tree_representation(con);
-            sasprintf(&_title, "i3: %s", tree);
-            free(tree);
-
-            title = i3string_from_utf8(_title);
-            FREE(_title);
+        if (parent->layout == L_TABBED || parent->layout == L_STACKED) {
+            x_draw_title_strip(con, p, title, mark, mark_width);
         } else {
-            title = con_parse_title_format(con);
+            x_free_title_strip(con);
+            x_draw_title_bar(con, p, &(parent->frame_buffer), &(con->deco_rect), title, mark, mark_width);
         }
-    } else {
-        title = con->title_format == NULL ? win->name : con_parse_title_format(con);
-    }
-    if (title == NULL) {
-        goto copy_pixmaps;
-    }
+        x_damage(parent, con->deco_rect.x, con->deco_rect.y, con->deco_rect.width, con->deco_rect.height);
 
-    int title_offset_x;
-    switch (config.title_align) {
-        case ALIGN_LEFT:
-            /* (pad)[text    ](pad)[mark + its pad) */
-            title_offset_x = title_padding;
-            break;
-        case ALIGN_CENTER:
-            /* (pad)[  text  ](pad)[mark + its pad)
-             * To center the text inside its allocated space, the surface
-             * between the brackets, we use the formula
-             * (surface_width - predict_text_width) / 2
-             * where surface_width = deco_width - 2 * pad - mark_width
-             * so, offset = pad + (surface_width - predict_text_width) / 2 =
-             * = … = (deco_width - mark_width - predict_text_width) / 2 */
-            title_offset_x = max(title_padding, (deco_width - mark_width - predict_text_width(title)) / 2);
-            break;
-        case ALIGN_RIGHT:
-            /* [mark + its pad](pad)[    text](pad) */
-            title_offset_x = max(title_padding + mark_width, deco_width - title_padding - predict_text_width(title));
-            break;
-    }
-
-    draw_util_text(title, &(parent->frame_buffer),
-                   p->color->text, p->color->background,
-                   con->deco_rect.x + text_offset_x + title_offset_x,
-                   con->deco_rect.y + text_offset_y,
-                   deco_width - text_offset_x - mark_width - 2 * title_padding);
-
-    if (win == NULL || con->title_format != NULL) {
-        I3STRING_FREE(title);
+        if (title_owned) {
+            I3STRING_FREE(title);
+        }
     }
 
-    x_draw_decoration_after_title(con, p);
 copy_pixmaps:
-    draw_util_copy_surface(&(con->frame_buffer), &(con->frame), 0, 0, 0, 0, con->rect.width, con->rect.height);
+    x_copy_damage(con);
 }
 
 /*
@@ -746,7 +1261,12 @@ void x_deco_recurse(Con *con) {
     Con *current;
     bool leaf = TAILQ_EMPTY(&(con->nodes_head)) &&
                 TAILQ_EMPTY(&(con->floating_head));
-    con_state *state = state_for_frame(con->frame.id);
+
+    /* Decorations of hidden workspaces are drawn once they become visible. */
+    if (con_is_clean_hidden_workspace(con))
+        return;
+
+    con_state *state = state_for_con(con);
 
     if (!leaf) {
         TAILQ_FOREACH (current, &(con->nodes_head), nodes) {
@@ -758,7 +1278,7 @@ void x_deco_recurse(Con *con) {
         }
 
         if (state->mapped) {
-            draw_util_copy_surface(&(con->frame_buffer), &(con->frame), 0, 0, 0, 0, con->rect.width, con->rect.height);
+            x_copy_damage(con);
         }
     }
 
@@ -776,7 +1296,7 @@ static void set_hidden_state(Con *con) {
         return;
     }
 
-    con_state *state = state_for_frame(con->frame.id);
+    con_state *state = state_for_con(con);
     bool should_be_hidden = con_is_hidden(con);
     if (should_be_hidden == state->is_hidden)
         return;
@@ -831,7 +1351,7 @@ static void set_shape_state(Con *con, bool need_reshape) {
     }
 
     struct con_state *state;
-    if ((state = state_for_frame(con->frame.id)) == NULL) {
+    if ((state = state_for_con(con)) == NULL) {
         ELOG("window state for con %p not found\n", con);
         return;
     }
@@ -857,6 +1377,29 @@ static void set_shape_state(Con *con, bool need_reshape) {
     }
 }
 
+/*
+ * Returns the rectangle x_push_node() will give the frame of the given
+ * container: containers without a window are only as high as the decorations
+ * of their children.
+ *
+ */
+static Rect x_frame_rect(Con *con) {
+    Rect rect = con->rect;
+    if (con->window == NULL) {
+        Con *current;
+        uint32_t max_y = 0, max_height = 0;
+        TAILQ_FOREACH (current, &(con->nodes_head), nodes) {
+            Rect *dr = &(current->deco_rect);
+            if (dr->y >= max_y && dr->height >= max_height) {
+                max_y = dr->y;
+                max_height = dr->height;
+            }
+        }
+        rect.height = max_y + max_height;
+    }
+    return rect;
+}
+
 /*
  * This function pushes the properties of each node of the layout tree to
  * X11 if they have changed (like the map state, position of the window, …).
@@ -866,10 +1409,13 @@ static void set_shape_state(Con *con, bool need_reshape) {
 void x_push_node(Con *con) {
     Con *current;
     con_state *state;
-    Rect rect = con->rect;
+
+    /* Hidden workspaces in which nothing changed have already been pushed. */
+    if (con_is_clean_hidden_workspace(con))
+        return;
 
     //DLOG("Pushing changes for node %p / %s\n", con, con->name);
-    state = state_for_frame(con->frame.id);
+    state = state_for_con(con);
 
     if (state->name != NULL) {
         DLOG("pushing name %s for con %p\n", state->name, con);
@@ -879,21 +1425,11 @@ void x_push_node(Con *con) {
         FREE(state->name);
     }
 
-    if (con->window == NULL) {
-        /* Calculate the height of all window decorations which will be drawn on to
-         * this frame. */
-        uint32_t max_y = 0, max_height = 0;
-        TAILQ_FOREACH (current, &(con->nodes_head), nodes) {
-            Rect *dr = &(current->deco_rect);
-            if (dr->y >= max_y && dr->height >= max_height) {
-                max_y = dr->y;
-                max_height = dr->height;
-            }
-        }
-        rect.height = max_y + max_height;
-        if (rect.height == 0)
-            con->mapped = false;
-    }
+    /* Frames of containers without a window only span the window decorations
+     * which will be drawn on to them. */
+    Rect rect = x_frame_rect(con);
+    if (con->window == NULL && rect.height == 0)
+        con->mapped = false;
 
     bool need_reshape = false;
 
@@ -915,6 +1451,7 @@ void x_push_node(Con *con) {
         xcb_change_window_attributes(conn, state->old_frame, XCB_CW_EVENT_MASK, values);
         values[0] = CHILD_EVENT_MASK;
         xcb_change_window_attributes(conn, con->window->id, XCB_CW_EVENT_MASK, values);
+        push_requests.event_masks += 4;
 
         state->old_frame = XCB_NONE;
         state->need_reparent = false;
@@ -963,19 +1500,10 @@ void x_push_node(Con *con) {
         /* Check if the container has an unneeded pixmap left over from
          * previously having a border or titlebar. */
         if (!is_pixmap_needed && con->frame_buffer.id != XCB_NONE) {
-            draw_util_surface_free(conn, &(con->frame_buffer));
-            xcb_free_pixmap(conn, con->frame_buffer.id);
-            con->frame_buffer.id = XCB_NONE;
+            x_release_frame_buffer(con);
         }
 
         if (is_pixmap_needed && (has_rect_changed || con->frame_buffer.id == XCB_NONE)) {
-            if (con->frame_buffer.id == XCB_NONE) {
-                con->frame_buffer.id = xcb_generate_id(conn);
-            } else {
-                draw_util_surface_free(conn, &(con->frame_buffer));
-                xcb_free_pixmap(conn, con->frame_buffer.id);
-            }
-
             uint16_t win_depth = root_depth;
             if (con->window)
                 win_depth = con->window->depth;
@@ -986,19 +1514,11 @@ void x_push_node(Con *con) {
             int width = MAX((int32_t)rect.width, 1);
             int height = MAX((int32_t)rect.height, 1);
 
-            xcb_create_pixmap(conn, win_depth, con->frame_buffer.id, con->frame.id, width, height);
-            draw_util_surface_init(conn, &(con->frame_buffer), con->frame_buffer.id,
-                                   get_visualtype_by_id(get_visualid_by_depth(win_depth)), width, height);
-
-            /* For the graphics context, we disable GraphicsExposure events.
-             * Those will be sent when a CopyArea request cannot be fulfilled
-             * properly due to parts of the source being unmapped or otherwise
-             * unavailable. Since we always copy from pixmaps to windows, this
-             * is not a concern for us. */
-            xcb_change_gc(conn, con->frame_buffer.gc, XCB_GC_GRAPHICS_EXPOSURES, (uint32_t[]){0});
+            /* A frame buffer which was only moved still has valid contents. */
+            if (!x_acquire_frame_buffer(con, win_depth, width, height))
+                con->pixmap_recreated = true;
 
             draw_util_surface_set_size(&(con->frame), width, height);
-            con->pixmap_recreated = true;
 
             /* Don’t render the decoration for windows inside a stack which are
              * not visible right now */
@@ -1019,9 +1539,9 @@ void x_push_node(Con *con) {
          * fast as possible) */
         xcb_flush(conn);
         xcb_set_window_rect(conn, con->frame.id, rect);
-        if (con->frame_buffer.id != XCB_NONE) {
-            draw_util_copy_surface(&(con->frame_buffer), &(con->frame), 0, 0, 0, 0, con->rect.width, con->rect.height);
-        }
+        push_requests.configures++;
+        /* The frame lost its contents. */
+        x_repaint_region(con, (Rect){0, 0, con->rect.width, con->rect.height});
         xcb_flush(conn);
 
         memcpy(&(state->rect), &rect, sizeof(Rect));
@@ -1034,6 +1554,7 @@ void x_push_node(Con *con) {
         DLOG("setting window rect (%d, %d, %d, %d)\n",
              con->window_rect.x, con->window_rect.y, con->window_rect.width, con->window_rect.height);
         xcb_set_window_rect(conn, con->window->id, con->window_rect);
+        push_requests.configures++;
         memcpy(&(state->window_rect), &(con->window_rect), sizeof(Rect));
         fake_notify = true;
     }
@@ -1063,6 +1584,8 @@ void x_push_node(Con *con) {
              * mapped */
             values[0] = CHILD_EVENT_MASK;
             xcb_change_window_attributes(conn, con->window->id, XCB_CW_EVENT_MASK, values);
+            push_requests.maps++;
+            push_requests.event_masks++;
             DLOG("mapping child window (serial %d)\n", cookie.sequence);
             state->child_mapped = true;
         }
@@ -1071,11 +1594,11 @@ void x_push_node(Con *con) {
 
         values[0] = FRAME_EVENT_MASK;
         xcb_change_window_attributes(conn, con->frame.id, XCB_CW_EVENT_MASK, values);
+        push_requests.maps++;
+        push_requests.event_masks++;
 
         /* copy the pixmap contents to the frame window immediately after mapping */
-        if (con->frame_buffer.id != XCB_NONE) {
-            draw_util_copy_surface(&(con->frame_buffer), &(con->frame), 0, 0, 0, 0, con->rect.width, con->rect.height);
-        }
+        x_repaint_region(con, (Rect){0, 0, con->rect.width, con->rect.height});
         xcb_flush(conn);
 
         DLOG("mapping container %08x (serial %d)\n", con->frame.id, cookie.sequence);
@@ -1113,8 +1636,11 @@ static void x_push_node_unmaps(Con *con) {
     Con *current;
     con_state *state;
 
+    if (con_is_clean_hidden_workspace(con))
+        return;
+
     //DLOG("Pushing changes (with unmaps) for node %p / %s\n", con, con->name);
-    state = state_for_frame(con->frame.id);
+    state = state_for_con(con);
 
     /* map/unmap if map state changed, also ensure that the child window
      * is changed if we are mapped *and* in initial state (meaning the
@@ -1129,6 +1655,7 @@ static void x_push_node_unmaps(Con *con) {
         }
 
         cookie = xcb_unmap_window(conn, con->frame.id);
+        push_requests.unmaps++;
         DLOG("unmapping container %p / %s (serial %d)\n", con, con->name, cookie.sequence);
         /* we need to increase ignore_unmap for this container (if it
          * contains a window) and for every window "under" this one which
@@ -1138,6 +1665,7 @@ static void x_push_node_unmaps(Con *con) {
             DLOG("ignore_unmap for con %p (frame 0x%08x) now %d\n", con, con->frame.id, con->ignore_unmap);
         }
         state->mapped = con->mapped;
+        state->unmap_now = false;
     }
 
     /* handle all children and floating windows of this node */
@@ -1168,6 +1696,214 @@ static bool is_con_attached(Con *con) {
     return false;
 }
 
+/* The new window stack (bottom to top) and the scratch space for computing
+ * the minimal restack, see x_plan_stack(). */
+static con_state **stack = NULL;
+static int *stack_tails = NULL;
+static int *stack_predecessors = NULL;
+static int stack_size = 0;
+static int stack_count = 0;
+static con_state *stack_anchor = NULL;
+
+/*
+ * Decides which windows need to be restacked to make X11 match the order of
+ * state_head, setting need_restack on their state.
+ *
+ * old_state_head is the order X11 currently has. The windows which form the
+ * longest common subsequence of the old and the new order are already
+ * correctly stacked relative to each other, so only the remaining windows
+ * (and new windows) need to be restacked. Since both lists contain the same
+ * states, this is the longest increasing subsequence of the old positions
+ * when walking the new stack, which is found in O(n log n).
+ *
+ */
+static void x_plan_stack(void) {
+    con_state *state;
+    int cnt = 0;
+    CIRCLEQ_FOREACH_REVERSE (state, &old_state_head, old_state) {
+        state->old_position = cnt++;
+    }
+
+    if (cnt > stack_size) {
+        stack = srealloc(stack, sizeof(con_state *) * cnt);
+        stack_tails = srealloc(stack_tails, sizeof(int) * cnt);
+        stack_predecessors = srealloc(stack_predecessors, sizeof(int) * cnt);
+        stack_size = cnt;
+    }
+
+    stack_count = 0;
+    CIRCLEQ_FOREACH_REVERSE (state, &state_head, state) {
+        state->need_restack = true;
+        stack[stack_count++] = state;
+    }
+
+    /* Longest increasing subsequence of old_position. stack_tails[k] is the
+     * index (in stack) of the smallest tail of all increasing subsequences of
+     * length k + 1. New windows have no meaningful old position and always
+     * need to be stacked. */
+    int length = 0;
+    for (int i = 0; i < stack_count; i++) {
+        if (stack[i]->initial) {
+            continue;
+        }
+        int lo = 0, hi = length;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (stack[stack_tails[mid]]->old_position < stack[i]->old_position) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        stack_predecessors[i] = (lo > 0 ? stack_tails[lo - 1] : -1);
+        stack_tails[lo] = i;
+        if (lo == length) {
+            length++;
+        }
+    }
+    for (int i = (length > 0 ? stack_tails[length - 1] : -1); i != -1; i = stack_predecessors[i]) {
+        stack[i]->need_restack = false;
+    }
+    stack_anchor = (length > 0 ? stack[stack_tails[0]] : NULL);
+
+    /* Without any window staying in place, the bottom-most window is the
+     * reference for all others. */
+    if (stack_count > 0 && stack_anchor == NULL) {
+        stack[0]->need_restack = false;
+    }
+}
+
+/*
+ * Restacks the windows selected by x_plan_stack(), each directly above its
+ * new lower neighbour.
+ *
+ * Returns the number of restack requests which were sent.
+ *
+ */
+static int x_push_stack(void) {
+    int restacks = 0;
+    uint32_t mask = XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE;
+    for (int i = 0; i < stack_count; i++) {
+        con_state *state = stack[i];
+        state->initial = false;
+        if (!state->need_restack) {
+            continue;
+        }
+
+        if (i > 0) {
+            //DLOG("Stacking 0x%08x above 0x%08x\n", state->id, stack[i - 1]->id);
+            uint32_t values[] = {stack[i - 1]->id, XCB_STACK_MODE_ABOVE};
+            xcb_configure_window(conn, state->id, mask, values);
+        } else {
+            /* The bottom-most window moved: put it below the lowest window
+             * which stays where it is. The following windows will then be
+             * stacked on top of it. */
+            uint32_t values[] = {stack_anchor->id, XCB_STACK_MODE_BELOW};
+            xcb_configure_window(conn, state->id, mask, values);
+        }
+        restacks++;
+    }
+
+    DLOG("Restacked %d of %d windows\n", restacks, stack_count);
+    return restacks;
+}
+
+/* Screen areas in which the window under the pointer might change during the
+ * current x_push_changes(), see x_mask_enter(). */
+static Rect *enter_areas = NULL;
+static int enter_areas_size = 0;
+static int enter_areas_count = 0;
+
+static void add_enter_area(Rect rect) {
+    if (enter_areas_count == enter_areas_size) {
+        enter_areas_size = (enter_areas_size == 0 ? 32 : enter_areas_size * 2);
+        enter_areas = srealloc(enter_areas, sizeof(Rect) * enter_areas_size);
+    }
+    enter_areas[enter_areas_count++] = rect;
+}
+
+static bool rect_overlaps(Rect a, Rect b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width &&
+           a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+/*
+ * Selects the mapped frames which x_push_node() will move or resize (also if
+ * only the child window changes) and records their old and new rectangles.
+ *
+ */
+static void x_collect_moves(Con *con) {
+    if (con_is_clean_hidden_workspace(con))
+        return;
+
+    con_state *state = state_for_con(con);
+    if (state->mapped) {
+        Rect rect = x_frame_rect(con);
+        if ((!rect_equals(state->rect, rect) && rect.height > 0) ||
+            (con->window != NULL && !rect_equals(state->window_rect, con->window_rect))) {
+            state->mask_enter = true;
+            add_enter_area(state->rect);
+            add_enter_area(rect);
+        }
+    }
+
+    Con *current;
+    TAILQ_FOREACH (current, &(con->focus_head), focused) {
+        x_collect_moves(current);
+    }
+}
+
+/*
+ * Disables EnterNotify on the frames which might get one while pushing the
+ * changes: the frames which are moved, resized or restacked, and the frames
+ * which they might reveal under the pointer. When the pointer gets warped,
+ * all frames are affected.
+ *
+ * Returns the number of frames which were masked.
+ *
+ */
+static int x_mask_enter(Con *con) {
+    con_state *state;
+    enter_areas_count = 0;
+
+    x_collect_moves(con);
+    CIRCLEQ_FOREACH (state, &state_head, state) {
+        if (state->mapped && state->need_restack) {
+            state->mask_enter = true;
+            add_enter_area(state->rect);
+        }
+    }
+
+    /* We need to keep SubstructureRedirect around, otherwise clients can send
+     * ConfigureWindow requests and get them applied directly instead of having
+     * them become ConfigureRequests that i3 handles. */
+    uint32_t values[] = {XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT};
+    int masked = 0;
+    CIRCLEQ_FOREACH_REVERSE (state, &state_head, state) {
+        if (!state->mapped)
+            continue;
+
+        if (!state->mask_enter) {
+            if (warp_to) {
+                state->mask_enter = true;
+            } else {
+                for (int i = 0; i < enter_areas_count; i++) {
+                    if (rect_overlaps(state->rect, enter_areas[i])) {
+                        state->mask_enter = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (state->mask_enter) {
+            xcb_change_window_attributes(conn, state->id, XCB_CW_EVENT_MASK, values);
+            masked++;
+        }
+    }
+    return masked;
+}
+
 /*
  * Pushes all changes (state of each node, see x_push_node() and the window
  * stack) to X11.
@@ -1188,18 +1924,18 @@ void x_push_changes(Con *con) {
         pointercookie = xcb_query_pointer(conn, root);
     }
 
+    memset(&push_requests, 0, sizeof(push_requests));
+
     DLOG("-- PUSHING WINDOW STACK --\n");
-    //DLOG("Disabling EnterNotify\n");
-    /* We need to keep SubstructureRedirect around, otherwise clients can send
-     * ConfigureWindow requests and get them applied directly instead of having
-     * them become ConfigureRequests that i3 handles. */
-    uint32_t values[1] = {XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT};
-    CIRCLEQ_FOREACH_REVERSE (state, &state_head, state) {
-        if (state->mapped)
-            xcb_change_window_attributes(conn, state->id, XCB_CW_EVENT_MASK, values);
-    }
-    //DLOG("Done, EnterNotify disabled\n");
-    bool order_changed = false;
+    x_plan_stack();
+
+    /* Disable EnterNotify on the frames which might get one because of our own
+     * changes instead of a pointer movement. */
+    int masked = x_mask_enter(con);
+    push_requests.event_masks += masked;
+    DLOG("Disabled EnterNotify on %d frames\n", masked);
+
+    uint32_t values[1];
     bool stacking_changed = false;
 
     /* count first, necessary to (re)allocate memory for the bottom-to-top
@@ -1227,23 +1963,11 @@ void x_push_changes(Con *con) {
     CIRCLEQ_FOREACH_REVERSE (state, &state_head, state) {
         if (con_has_managed_window(state->con))
             memcpy(walk++, &(state->con->window->id), sizeof(xcb_window_t));
+    }
 
-        //DLOG("stack: 0x%08x\n", state->id);
-        con_state *prev = CIRCLEQ_PREV(state, state);
-        con_state *old_prev = CIRCLEQ_PREV(state, old_state);
-        if (prev != old_prev)
-            order_changed = true;
-        if ((state->initial || order_changed) && prev != CIRCLEQ_END(&state_head)) {
-            stacking_changed = true;
-            //DLOG("Stacking 0x%08x above 0x%08x\n", prev->id, state->id);
-            uint32_t mask = 0;
-            mask |= XCB_CONFIG_WINDOW_SIBLING;
-            mask |= XCB_CONFIG_WINDOW_STACK_MODE;
-            uint32_t values[] = {state->id, XCB_STACK_MODE_ABOVE};
-
-            xcb_configure_window(conn, prev->id, mask, values);
-        }
-        state->initial = false;
+    push_requests.restacks = x_push_stack();
+    if (push_requests.restacks > 0) {
+        stacking_changed = true;
     }
 
     /* If we re-stacked something (or a new window appeared), we need to update
@@ -1281,6 +2005,7 @@ void x_push_changes(Con *con) {
                 xcb_change_window_attributes(conn, root, XCB_CW_EVENT_MASK, (uint32_t[]){XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT});
                 xcb_warp_pointer(conn, XCB_NONE, root, 0, 0, 0, 0, mid_x, mid_y);
                 xcb_change_window_attributes(conn, root, XCB_CW_EVENT_MASK, (uint32_t[]){ROOT_EVENT_MASK});
+                push_requests.event_masks += 2;
             }
 
             free(pointerreply);
@@ -1288,13 +2013,16 @@ void x_push_changes(Con *con) {
         warp_to = NULL;
     }
 
-    //DLOG("Re-enabling EnterNotify\n");
     values[0] = FRAME_EVENT_MASK;
     CIRCLEQ_FOREACH_REVERSE (state, &state_head, state) {
-        if (state->mapped)
+        if (!state->mask_enter)
+            continue;
+        state->mask_enter = false;
+        if (state->mapped) {
             xcb_change_window_attributes(conn, state->id, XCB_CW_EVENT_MASK, values);
+            push_requests.event_masks++;
+        }
     }
-    //DLOG("Done, EnterNotify re-enabled\n");
 
     x_deco_recurse(con);
 
@@ -1327,11 +2055,13 @@ void x_push_changes(Con *con) {
                 if (focused->window != NULL) {
                     values[0] = CHILD_EVENT_MASK & ~(XCB_EVENT_MASK_FOCUS_CHANGE);
                     xcb_change_window_attributes(conn, focused->window->id, XCB_CW_EVENT_MASK, values);
+                    push_requests.event_masks++;
                 }
                 xcb_set_input_focus(conn, XCB_INPUT_FOCUS_POINTER_ROOT, to_focus, last_timestamp);
                 if (focused->window != NULL) {
                     values[0] = CHILD_EVENT_MASK;
                     xcb_change_window_attributes(conn, focused->window->id, XCB_CW_EVENT_MASK, values);
+                    push_requests.event_masks++;
                 }
 
                 change_ewmh_focus((con_has_managed_window(focused) ? focused->window->id : XCB_WINDOW_NONE), last_focused);
@@ -1370,6 +2100,7 @@ void x_push_changes(Con *con) {
         if (!state->unmap_now)
             continue;
         xcb_change_window_attributes(conn, state->id, XCB_CW_EVENT_MASK, values);
+        push_requests.event_masks++;
     }
 
     /* Push all pending unmaps */
@@ -1384,6 +2115,25 @@ void x_push_changes(Con *con) {
     //    DLOG("old stack: 0x%08x\n", state->id);
     //}
 
+    DLOG("X11 requests for this push: %d event masks, %d restacks, %d configures, %d maps, %d unmaps\n",
+         push_requests.event_masks, push_requests.restacks, push_requests.configures,
+         push_requests.maps, push_requests.unmaps);
+    DLOG("Decoration redraws: %d uncached, %d title, %d marks, %d pixmap, %d colors, %d size, %d layout (title strips: %d rendered, %d copied)\n",
+         deco_redraws.uncached, deco_redraws.title, deco_redraws.marks, deco_redraws.pixmap,
+         deco_redraws.colors, deco_redraws.size, deco_redraws.layout,
+         deco_redraws.strips_rendered, deco_redraws.strips_copied);
+    DLOG("Copied %d frame regions (%llu bytes)\n", frame_copies.regions, (unsigned long long)frame_copies.bytes);
+    frame_copy_stats.pushes++;
+    frame_copy_stats.regions += frame_copies.regions;
+    frame_copy_stats.bytes += frame_copies.bytes;
+    frame_copy_stats.last_regions = frame_copies.regions;
+    frame_copy_stats.last_bytes = frame_copies.bytes;
+    memset(&deco_redraws, 0, sizeof(deco_redraws));
+    memset(&frame_copies, 0, sizeof(frame_copies));
+    DLOG("Frame buffers: %d created, %d reused, %d kept, %d pooled\n",
+         frame_buffers.created, frame_buffers.reused, frame_buffers.kept, pooled_frame_buffers_count);
+    memset(&frame_buffers, 0, sizeof(frame_buffers));
+
     xcb_flush(conn);
 }
 
@@ -1394,7 +2144,7 @@ void x_push_changes(Con *con) {
  */
 void x_raise_con(Con *con) {
     con_state *state;
-    state = state_for_frame(con->frame.id);
+    state = state_for_con(con);
     //DLOG("raising in new stack: %p / %s / %s / xid %08x\n", con, con->name, con->window ? con->window->name_json : "", state->id);
 
     CIRCLEQ_REMOVE(&state_head, state, state);
@@ -1410,13 +2160,14 @@ void x_raise_con(Con *con) {
 void x_set_name(Con *con, const char *name) {
     struct con_state *state;
 
-    if ((state = state_for_frame(con->frame.id)) == NULL) {
+    if ((state = state_for_con(con)) == NULL) {
         ELOG("window state not found\n");
         return;
     }
 
     FREE(state->name);
     state->name = sstrdup(name);
+    con_mark_dirty(con);
 }
 
 /*
@@ -1481,7 +2232,7 @@ void x_mask_event_mask(uint32_t mask) {
  */
 void x_set_shape(Con *con, xcb_shape_sk_t kind, bool enable) {
     struct con_state *state;
-    if ((state = state_for_frame(con->frame.id)) == NULL) {
+    if ((state = state_for_con(con)) == NULL) {
         ELOG("window state for con %p not found\n", con);
         return;
     }
@@ -1509,3 +2260,12 @@ void x_set_shape(Con *con, xcb_shape_sk_t kind, bool enable) {
         xcb_flush(conn);
     }
 }
+
+/*
+ * Returns the number of frame buffer regions copied to frames and their size
+ * in bytes, in total and for the last push.
+ *
+ */
+void x_frame_copy_stats(x_frame_copy_stats_t *stats) {
+    *stats = frame_copy_stats;
+}
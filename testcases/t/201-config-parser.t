@@ -545,6 +545,7 @@ my $expected_all_tokens = "ERROR: CONFIG: Expected one of these tokens: <end>, '
         ipc_socket
         ipc-socket
         ipc_kill_timeout
+        ipc_high_water_mark
         restart_state
         popup_during_fullscreen
         exec_always
@@ -0,0 +1,96 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Test that a client which does not read its events is disconnected as soon
+# as more than ipc_high_water_mark bytes of events are queued for it, without
+# waiting for ipc_kill_timeout, and that replies do not count.
+use i3test i3_config => <<EOT;
+# i3 config file (v4)
+font -misc-fixed-medium-r-normal--13-120-75-75-C-70-iso10646-1
+ipc_kill_timeout 60000
+ipc_high_water_mark 65536
+EOT
+
+use IO::Select;
+use IO::Socket::UNIX;
+
+my $magic = "i3-ipc";
+
+# Manually connect to i3 so that we can choose to not read events
+sub subscribed_socket {
+    my $sock = IO::Socket::UNIX->new(Peer => get_socket_path());
+    my $payload = '["workspace"]';
+    print $sock $magic . pack("LL", length($payload), 2) . $payload;
+    return $sock;
+}
+
+fresh_workspace;
+open_window;
+fresh_workspace;
+open_window;
+
+################################################################################
+# Replies to the client's own requests do not count towards the limit.
+################################################################################
+
+my $sock = subscribed_socket;
+my $requests = 200;
+print $sock ($magic . pack("LL", 0, 4)) x $requests;
+sync_with_i3;
+
+# Trigger a workspace event while the replies are queued.
+cmd 'workspace back_and_forth';
+cmd 'workspace back_and_forth';
+
+my $replies = 0;
+my $s = IO::Select->new($sock);
+while ($replies < $requests && $s->can_read(1)) {
+    my $header;
+    last if read($sock, $header, 14) != 14;
+    my ($len, $type) = unpack("LL", substr($header, 6));
+    last if read($sock, my $buffer, $len) != $len;
+    $replies++ if $type == 4;
+}
+is($replies, $requests, 'all GET_TREE replies received');
+close $sock;
+
+################################################################################
+# A client which does not read its events is disconnected.
+################################################################################
+
+$sock = subscribed_socket;
+
+# Generate events until the socket buffer is full and more than 64 KiB are
+# queued in i3.
+for (my $i = 0; $i < 2000; $i++) {
+    cmd 'workspace back_and_forth';
+}
+
+# i3 is still responsive.
+does_i3_live;
+
+$s = IO::Select->new($sock);
+my $reached_eof = 0;
+while ($s->can_read(0.5)) {
+    if (read($sock, my $buffer, 65536) == 0) {
+        $reached_eof = 1;
+        last;
+    }
+}
+ok($reached_eof, 'socket connection closed');
+
+close $sock;
+done_testing;
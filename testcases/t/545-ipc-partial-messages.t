@@ -0,0 +1,65 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Test that i3 keeps handling other clients while a client sends a message in
+# pieces, and that several messages sent at once are all answered.
+use i3test;
+use IO::Socket::UNIX;
+
+my $sock = IO::Socket::UNIX->new(Peer => get_socket_path());
+$sock->autoflush(1);
+
+sub message {
+    my ($type, $payload) = @_;
+    return "i3-ipc" . pack("LL", length($payload), $type) . $payload;
+}
+
+sub read_reply {
+    my $header;
+    read($sock, $header, 14) == 14 or return undef;
+    my ($len, $type) = unpack("LL", substr($header, 6));
+    my $payload = '';
+    read($sock, $payload, $len) if $len > 0;
+    return [ $type, $payload ];
+}
+
+################################################################################
+# A partial header and a partial payload do not block i3.
+################################################################################
+
+my $command = message(0, 'nop partial');
+print $sock substr($command, 0, 8);
+does_i3_live;
+
+print $sock substr($command, 8, 10);
+does_i3_live;
+
+print $sock substr($command, 18);
+my $reply = read_reply;
+is($reply->[0], 0, 'got a COMMAND reply');
+like($reply->[1], qr/"success":true/, 'command was successful');
+
+################################################################################
+# Several messages in one write are all handled.
+################################################################################
+
+print $sock message(7, '') . message(0, 'nop first') . message(7, '');
+is(read_reply->[0], 7, 'got a VERSION reply');
+is(read_reply->[0], 0, 'got a COMMAND reply');
+is(read_reply->[0], 7, 'got a second VERSION reply');
+
+close $sock;
+done_testing;
@@ -0,0 +1,138 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Tests for the tree IPC event and the GET_TREE_SNAPSHOT message.
+use i3test;
+use List::Util qw(first);
+use X11::XCB qw(PROP_MODE_REPLACE);
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+sub snapshot {
+    return $i3->message(AnyEvent::I3::TYPE_GET_TREE_SNAPSHOT)->recv;
+}
+
+sub changes_of {
+    my ($type, @events) = @_;
+    return grep { $_->{type} eq $type } map { @{$_->{changes}} } @events;
+}
+
+my $ws = fresh_workspace;
+my $generation = snapshot()->{generation};
+ok(defined($generation), 'snapshot has a generation');
+ok(defined(snapshot()->{tree}->{nodes}), 'snapshot contains the tree');
+
+###############################################################################
+# Opening a window reports the new node and the new children of the workspace.
+###############################################################################
+
+my $window;
+my @events = events_for(
+    sub { $window = open_window },
+    'tree');
+
+ok(@events > 0, 'received tree events');
+is($events[0]->{change}, 'delta', 'change is delta');
+cmp_ok($events[0]->{generation}, '>', $generation, 'generation increased');
+for my $i (1 .. $#events) {
+    is($events[$i]->{generation}, $events[$i - 1]->{generation} + 1,
+       'generations are consecutive');
+}
+
+my $added = first { ($_->{node}->{window} // 0) == $window->id } changes_of('add', @events);
+ok(defined($added), 'new window was added');
+ok(!exists($added->{node}->{nodes}), 'added node is sent without children');
+my $id = $added->{node}->{id};
+
+my @children = changes_of('children', @events);
+ok((first { grep { $_ == $id } @{$_->{nodes}} } @children),
+   'new window is in the children of its parent');
+
+###############################################################################
+# Setting a mark is reported as a property change.
+###############################################################################
+
+@events = events_for(
+    sub { cmd 'mark tree-delta' },
+    'tree');
+
+my $changed = first { $_->{node}->{id} == $id } changes_of('property', @events);
+ok(defined($changed), 'marked window changed');
+is_deeply($changed->{properties}, [ 'marks' ], 'only the marks changed');
+is_deeply($changed->{node}->{marks}, [ 'tree-delta' ], 'node has the new mark');
+
+###############################################################################
+# Splitting the only window of a workspace changes the workspace layout.
+###############################################################################
+
+my $ws_id = get_ws($ws)->{id};
+@events = events_for(
+    sub { cmd 'split v' },
+    'tree');
+
+$changed = first { $_->{node}->{id} == $ws_id } changes_of('property', @events);
+ok(defined($changed), 'workspace changed');
+ok((grep { $_ eq 'layout' } @{$changed->{properties}}), 'layout changed');
+is($changed->{node}->{layout}, 'splitv', 'node has the new layout');
+
+###############################################################################
+# Changing the window class is reported as a property change.
+###############################################################################
+
+@events = events_for(
+    sub {
+        my $class = "delta\0Delta";
+        $x->change_property(
+            PROP_MODE_REPLACE,
+            $window->id,
+            $x->atom(name => 'WM_CLASS')->id,
+            $x->atom(name => 'STRING')->id,
+            8,
+            length($class) + 1,
+            $class);
+        $x->flush;
+        sync_with_i3;
+    },
+    'tree');
+
+$changed = first { $_->{node}->{id} == $id } changes_of('property', @events);
+ok(defined($changed), 'window changed');
+ok((grep { $_ eq 'window_properties' } @{$changed->{properties}}),
+   'window properties changed');
+is($changed->{node}->{window_properties}->{class}, 'Delta', 'node has the new class');
+
+###############################################################################
+# Closing the window reports its removal.
+###############################################################################
+
+@events = events_for(
+    sub {
+        cmd 'kill';
+        wait_for_unmap($window);
+    },
+    'tree');
+
+ok((first { $_->{id} == $id } changes_of('remove', @events)), 'window was removed');
+
+###############################################################################
+# A snapshot includes all changes sent so far.
+###############################################################################
+
+is(snapshot()->{generation}, $events[-1]->{generation},
+   'snapshot generation matches the last event');
+
+done_testing;
@@ -0,0 +1,93 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Tests for GET_TREE requests which select a root, a depth and fields.
+use i3test;
+use AnyEvent::I3 qw(:all);
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+sub get_tree {
+    my ($request) = @_;
+    return $i3->message(TYPE_GET_TREE, $request)->recv;
+}
+
+my $ws = fresh_workspace;
+my $window = open_window(wm_class => 'query');
+my $id = get_focused($ws);
+
+###############################################################################
+# Without a payload, the whole tree is dumped.
+###############################################################################
+
+my $tree = get_tree;
+is($tree->{type}, 'root', 'tree starts at the root');
+ok(exists($tree->{rect}), 'all fields are dumped');
+
+###############################################################################
+# A workspace can be selected as the root.
+###############################################################################
+
+$tree = get_tree({ workspace => $ws });
+is($tree->{type}, 'workspace', 'tree starts at the workspace');
+is($tree->{name}, $ws, 'tree starts at the requested workspace');
+is($tree->{nodes}->[0]->{window}, $window->id, 'window is dumped');
+
+###############################################################################
+# A container can be selected by its ID, with a depth of 0.
+###############################################################################
+
+$tree = get_tree({ con_id => $id, depth => 0 });
+is($tree->{id}, $id, 'tree starts at the container');
+ok(!exists($tree->{nodes}), 'children are left out with a depth of 0');
+ok(!exists($tree->{floating_nodes}), 'floating children are left out with a depth of 0');
+
+$tree = get_tree({ workspace => $ws, depth => 1 });
+is(scalar @{$tree->{nodes}}, 1, 'workspace has one child');
+ok(!exists($tree->{nodes}->[0]->{nodes}), 'grandchildren are left out with a depth of 1');
+
+###############################################################################
+# Only the requested fields are dumped.
+###############################################################################
+
+$tree = get_tree({ workspace => $ws, fields => [ 'id', 'name', 'focused', 'window_properties' ] });
+is_deeply([ sort keys %$tree ], [ qw(floating_nodes focused id name nodes) ],
+          'workspace has the requested fields');
+my $node = $tree->{nodes}->[0];
+is($node->{id}, $id, 'window has its id');
+ok($node->{focused}, 'window is focused');
+is($node->{window_properties}->{class}, 'query', 'window has its class');
+ok(!exists($node->{rect}), 'window has no rect');
+
+###############################################################################
+# Invalid requests are answered with an error.
+###############################################################################
+
+$tree = get_tree({ workspace => 'does-not-exist' });
+ok(!$tree->{success}, 'unknown workspace fails');
+ok(defined($tree->{error}), 'error is set');
+
+$tree = get_tree({ fields => [ 'no-such-field' ] });
+ok(!$tree->{success}, 'unknown field fails');
+
+$tree = get_tree({ con_id => $id, workspace => $ws });
+ok(!$tree->{success}, 'selecting two roots fails');
+
+$tree = get_tree('{ invalid');
+ok(!$tree->{success}, 'invalid JSON fails');
+
+done_testing;
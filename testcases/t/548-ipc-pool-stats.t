@@ -0,0 +1,52 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • http://onyxneon.com/books/modern_perl/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Tests for the GET_POOL_STATS message.
+use i3test;
+use AnyEvent::I3 qw(:all);
+use List::Util qw(first);
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+sub con_pool {
+    my $stats = $i3->message(TYPE_GET_POOL_STATS)->recv;
+    return first { $_->{name} eq 'Con' } @{$stats->{pools}};
+}
+
+fresh_workspace;
+my $before = con_pool;
+ok(defined($before), 'containers are pooled');
+ok($before->{in_use} > 0, 'containers are in use');
+
+open_window;
+my $after = con_pool;
+cmp_ok($after->{in_use}, '>', $before->{in_use}, 'new window allocated a container');
+cmp_ok($after->{allocations}, '>', $before->{allocations}, 'allocations increased');
+
+ok(defined($i3->message(TYPE_GET_POOL_STATS)->recv->{text_width_cache}->{hits}),
+   'text width cache counters are included');
+
+# Frame copies are counted cumulatively over all pushes.
+my $copies = $i3->message(TYPE_GET_POOL_STATS)->recv->{frame_copies};
+ok(defined($copies), 'frame copy counters are included');
+open_window;
+my $later = $i3->message(TYPE_GET_POOL_STATS)->recv->{frame_copies};
+cmp_ok($later->{pushes}, '>', $copies->{pushes}, 'pushes increased');
+cmp_ok($later->{regions}, '>=', $copies->{regions}, 'regions do not decrease');
+cmp_ok($later->{bytes}, '>', 0, 'bytes were copied');
+
+done_testing;